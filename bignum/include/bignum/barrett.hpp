@@ -0,0 +1,36 @@
+#pragma once
+
+#include "bignum/bignum.hpp"
+#include <cstddef>
+
+namespace bignum {
+
+// Редукция Барретта по фиксированному модулю N > 0 из k limb-ов.
+// Предвычисляется mu = floor(2^(128k) / N), после чего остаток числа до 2k limb-ов
+// (в частности, произведения двух вычетов) получается двумя умножениями и не более
+// чем двумя вычитаниями вместо деления. В отличие от формы Монтгомери, значения
+// остаются в обычном виде и годятся, например, как ключи хеш-таблиц.
+class BarrettReducer {
+public:
+    explicit BarrettReducer(const BigInt& modulus);
+
+    const BigInt& modulus() const { return modulus_; }
+
+    // x mod N в диапазоне [0, N), x любого знака; числа длиннее 2k limb-ов — обычным делением
+    BigInt reduce(const BigInt& x) const;
+    // a*b mod N в диапазоне [0, N)
+    BigInt mul(const BigInt& a, const BigInt& b) const;
+    // a*a mod N в диапазоне [0, N)
+    BigInt sqr(const BigInt& a) const;
+
+private:
+    bool is_reduced(const BigInt& x) const;            // 0 <= x < N
+    BigInt reduce_product(BigInt x) const;             // x mod N при 0 <= x < N^2
+    BigInt reduce_magnitude(const BigInt& x) const;    // x mod N при N <= x < 2^(128k)
+
+    BigInt modulus_;
+    BigInt mu_;   // floor(2^(128k) / N)
+    size_t k_{0}; // число limb-ов модуля
+};
+
+} // namespace bignum
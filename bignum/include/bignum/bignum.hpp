@@ -60,34 +60,92 @@ public:
     bool is_zero() const;
     bool is_negative() const;
     size_t bit_length() const;
+    bool test_bit(size_t bit) const; // бит модуля числа с номером bit (0 — младший)
+    uint64_t low_u64() const;        // младшие 64 бита модуля числа
+    uint64_t mod_u64(uint64_t d) const; // |this| mod d без выделения памяти, d != 0
+    static BigInt from_limbs(const uint64_t* limbs, size_t count); // неотрицательное число, младший limb первым
+    void to_limbs(uint64_t* out, size_t count) const; // младшие count limb-ов модуля, дополненные нулями
     BigInt abs() const;
 
     // --- Дополнительные методы ---
+    BigInt sqr() const;                  // this^2; x * x с одним и тем же объектом вызывает sqr()
     BigInt pow(const BigInt& exp) const; // this^exp, exp >= 0
     BigInt pow(uint64_t exp) const;      // this^exp, exp >= 0
     size_t log2() const;                 // floor(log2(this)), только для положительных
     size_t log10() const;                // floor(log10(this)), только для положительных
 
 private:
-    std::unique_ptr<uint64_t[]> limbs_{nullptr};
+    friend class MontgomeryContext;
+    friend class BarrettReducer;
+
+    // Малые числа (до INLINE_LIMBS limb-ов) хранятся внутри объекта без обращения к куче;
+    // limbs_ указывает либо на inline_, либо на heap_.
+    static constexpr size_t INLINE_LIMBS = 4;
+
+    uint64_t* limbs_{inline_};
+    std::unique_ptr<uint64_t[]> heap_{nullptr};
     size_t size_{0};
-    size_t capacity_{0};
+    size_t capacity_{INLINE_LIMBS};
     bool is_negative_{false};
+    uint64_t inline_[INLINE_LIMBS];
 
     // --- Приватные методы парсинга ---
     void from_hex_string(const std::string& hex_str);
     void from_dec_string(const std::string& dec_str);
 
+    // --- Десятичное преобразование "разделяй и властвуй" ---
+    static const BigInt& dec_power(size_t k); // 10^(19*2^k), кэшируется по потокам
+    static void to_dec_recursive(const BigInt& x, size_t k, size_t width, std::string& out);
+    static BigInt from_dec_recursive(const char* digits, size_t len);
+
     // --- Приватные "беззнаковые" версии для арифметики над модулями ---
     static BigInt add_magnitude(const BigInt& a, const BigInt& b);
     static BigInt subtract_magnitude(const BigInt& a, const BigInt& b);
     int compare_magnitude(const BigInt& other) const; // -1, 0, 1
+    // In-place версии для составных операторов: результат пишется прямо в limbs_
+    void add_signed_inplace(const BigInt& other, bool other_negative);
+    void add_magnitude_inplace(const BigInt& other);  // |this| += |other|
+    void sub_magnitude_inplace(const BigInt& other);  // |this| -= |other|, требуется |this| >= |other|
+    void rsub_magnitude_inplace(const BigInt& other); // |this| = |other| - |this|, требуется |other| > |this|
+    void mul_limb_inplace(uint64_t m);                // |this| *= m
+    uint64_t div_limb_inplace(uint64_t d);            // |this| /= d, возвращает остаток
     static std::pair<BigInt, BigInt> div_mod_magnitude(const BigInt& dividend, const BigInt& divisor);
 
+    // --- Умножение Тоома–Кука (над модулями, знак выставляет operator*) ---
+    static BigInt toom3_mul(const BigInt& a, const BigInt& b);
+    static BigInt toom4_mul(const BigInt& a, const BigInt& b);
+    BigInt slice_limbs(size_t from, size_t count) const; // |this| >> 64*from, взятые count limb-ов
+    void add_magnitude_at(const BigInt& other, size_t limb_offset); // |this| += |other| << 64*limb_offset
+
     // --- Приватные методы управления ---
     explicit BigInt(size_t num_limbs, bool zero_initialize);
     void resize(size_t new_capacity);
+    void grow(size_t min_capacity); // resize с геометрическим ростом ёмкости
+    void reallocate(size_t new_capacity); // новый буфер без сохранения содержимого
     void strip_leading_zeros();
 };
 
+// Ширина скользящего окна для показателя из exp_bits бит: таблица из 2^(w-1) нечётных степеней
+// окупается, когда показатель заметно длиннее неё. Общая для BigInt::pow и модульных возведений.
+size_t pow_window_bits(size_t exp_bits);
+
+// Разбиение показателя на скользящие окна не длиннее w бит слева направо. Для каждого окна
+// вызывается fn(low, digit): digit — нечётная цифра окна, low — позиция её младшего бита.
+// bit_at(i) — i-й бит показателя.
+template <class BitAt, class Fn>
+void for_each_pow_window(size_t exp_bits, size_t w, BitAt bit_at, Fn fn) {
+    for (size_t i = exp_bits; i > 0;) {
+        if (!bit_at(i - 1)) {
+            --i;
+            continue;
+        }
+        size_t low = i > w ? i - w : 0;
+        while (!bit_at(low)) ++low;
+        size_t digit = 0;
+        for (size_t b = i; b > low; --b) digit = (digit << 1) | size_t(bit_at(b - 1) ? 1 : 0);
+        fn(low, digit);
+        i = low;
+    }
+}
+
 } // namespace bignum
\ No newline at end of file
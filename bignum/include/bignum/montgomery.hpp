@@ -0,0 +1,52 @@
+#pragma once
+
+#include "bignum/bignum.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bignum {
+
+// Контекст умножения Монтгомери для фиксированного нечётного модуля N > 1.
+// R = 2^(64*k), где k — число limb-ов модуля. Предвычисляются R mod N, R^2 mod N
+// и n' = -N^{-1} mod 2^64, после чего умножение по модулю не требует деления.
+//
+// Низкоуровневые функции mont_mul/mont_sqr работают с "сырыми" массивами
+// длины limbs() в форме Монтгомери (значения < N). out может совпадать с a или b.
+// scratch — рабочий буфер длины scratch_limbs().
+class MontgomeryContext {
+public:
+    explicit MontgomeryContext(const BigInt& modulus);
+
+    const BigInt& modulus() const { return modulus_; }
+    size_t limbs() const { return n_.size(); }
+    size_t scratch_limbs() const { return 2 * n_.size() + 1; }
+
+    // Единица в форме Монтгомери (R mod N), массив длины limbs()
+    const uint64_t* one() const { return one_.data(); }
+
+    // a -> a*R mod N (a может быть любым, в т.ч. отрицательным); out длины limbs()
+    void to_montgomery(const BigInt& a, uint64_t* out) const;
+    // a*R -> a
+    BigInt from_montgomery(const uint64_t* a) const;
+
+    // out = a*b*R^{-1} mod N
+    void mont_mul(uint64_t* out, const uint64_t* a, const uint64_t* b, uint64_t* scratch) const;
+    // out = a*a*R^{-1} mod N
+    void mont_sqr(uint64_t* out, const uint64_t* a, uint64_t* scratch) const;
+
+    // Обычные (не Монтгомери) значения на входе и выходе
+    BigInt mul(const BigInt& a, const BigInt& b) const; // a*b mod N
+    BigInt pow(const BigInt& base, const BigInt& exp) const; // base^exp mod N, exp >= 0
+
+private:
+    void reduce_once(uint64_t* out, const uint64_t* t) const;
+
+    BigInt modulus_;
+    std::vector<uint64_t> n_;   // limb-ы модуля
+    std::vector<uint64_t> r2_;  // R^2 mod N
+    std::vector<uint64_t> one_; // R mod N
+    uint64_t n_prime_{0};       // -N^{-1} mod 2^64
+};
+
+} // namespace bignum
@@ -0,0 +1,112 @@
+#include "bignum/barrett.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <immintrin.h>
+
+namespace bignum {
+
+namespace {
+
+// С этой длины модуля (порог Карацубы) произведения BigInt дешевле школьного умножения
+constexpr size_t BARRETT_FAST_MUL_LIMBS = 32;
+
+} // namespace
+
+BarrettReducer::BarrettReducer(const BigInt& modulus) : modulus_(modulus.abs()) {
+    if (modulus_.is_zero()) throw std::invalid_argument("Barrett modulus must be non-zero");
+    k_ = (modulus_.bit_length() + 63) / 64;
+    mu_ = (BigInt(1) << (128 * k_)) / modulus_;
+}
+
+// q = floor(floor(x / 2^(64(k-1))) * mu / 2^(64(k+1))) занижает частное не более чем на 2,
+// поэтому r = x - q*N < 3N < 2^(64(k+1)) и считается по младшим k+1 limb-ам.
+BigInt BarrettReducer::reduce_magnitude(const BigInt& x) const {
+    const size_t k = k_;
+    if (k == 1) {
+        // Однолимбовый модуль: одно аппаратное деление дешевле двух умножений
+        const uint64_t r = x.mod_u64(modulus_.limbs_[0]);
+        return BigInt::from_limbs(&r, 1);
+    }
+    if (k >= BARRETT_FAST_MUL_LIMBS) {
+        // Длинный модуль: оба произведения — быстрым умножением BigInt
+        const BigInt q = ((x >> (64 * (k - 1))) * mu_) >> (64 * (k + 1));
+        BigInt r = x;
+        r -= q * modulus_;
+        while (r >= modulus_) r -= modulus_;
+        return r;
+    }
+
+    // Короткий модуль: школьное умножение в рабочем буфере потока, без временных BigInt
+    const uint64_t* n = modulus_.limbs_;
+    const uint64_t* q1 = x.limbs_ + (k - 1);
+    const size_t q1_size = x.size_ - (k - 1);
+    const size_t mu_size = mu_.size_;
+    thread_local std::vector<uint64_t> t;
+    t.assign(q1_size + mu_size, 0);
+    for (size_t i = 0; i < q1_size; ++i) {
+        unsigned __int128 carry = 0;
+        for (size_t j = 0; j < mu_size; ++j) {
+            unsigned __int128 cur = (unsigned __int128)q1[i] * mu_.limbs_[j] + t[i + j] + carry;
+            t[i + j] = (uint64_t)cur;
+            carry = cur >> 64;
+        }
+        t[i + mu_size] = (uint64_t)carry;
+    }
+    const uint64_t* q = t.data() + (k + 1);
+    const size_t q_size = t.size() > k + 1 ? t.size() - (k + 1) : 0;
+
+    // r = (x - q*N) mod 2^(64(k+1)): от q*N нужны только младшие k+1 limb-ов,
+    // они пишутся в младшую часть t, которая больше не нужна
+    uint64_t* prod = t.data();
+    std::fill(prod, prod + k + 1, 0);
+    for (size_t i = 0; i < q_size && i <= k; ++i) {
+        unsigned __int128 carry = 0;
+        for (size_t j = 0; j < k && i + j <= k; ++j) {
+            unsigned __int128 cur = (unsigned __int128)q[i] * n[j] + prod[i + j] + carry;
+            prod[i + j] = (uint64_t)cur;
+            carry = cur >> 64;
+        }
+        if (i == 0) prod[k] += (uint64_t)carry;
+    }
+    BigInt r(k + 1, true);
+    std::copy(x.limbs_, x.limbs_ + std::min(x.size_, k + 1), r.limbs_);
+    unsigned char borrow = 0;
+    for (size_t i = 0; i <= k; ++i) {
+        borrow = _subborrow_u64(borrow, r.limbs_[i], prod[i], reinterpret_cast<unsigned long long*>(&r.limbs_[i]));
+    }
+    r.strip_leading_zeros();
+    while (r >= modulus_) r.sub_magnitude_inplace(modulus_);
+    return r;
+}
+
+BigInt BarrettReducer::reduce(const BigInt& x) const {
+    if (x.is_negative()) {
+        BigInt r = reduce(-x);
+        return r.is_zero() ? r : modulus_ - r;
+    }
+    if (x < modulus_) return x;
+    if (x.bit_length() > 128 * k_) return x % modulus_;
+    return reduce_magnitude(x);
+}
+
+BigInt BarrettReducer::mul(const BigInt& a, const BigInt& b) const {
+    // Вычеты из [0, N) не копируются повторной редукцией
+    if (is_reduced(a) && is_reduced(b)) return reduce_product(a * b);
+    return reduce_product(reduce(a) * reduce(b));
+}
+
+BigInt BarrettReducer::sqr(const BigInt& a) const {
+    if (is_reduced(a)) return reduce_product(a.sqr());
+    return reduce_product(reduce(a).sqr());
+}
+
+bool BarrettReducer::is_reduced(const BigInt& x) const {
+    return !x.is_negative() && x < modulus_;
+}
+
+BigInt BarrettReducer::reduce_product(BigInt x) const {
+    return x < modulus_ ? x : reduce_magnitude(x);
+}
+
+} // namespace bignum
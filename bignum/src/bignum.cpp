@@ -2,7 +2,6 @@
 #include <memory>
 #include <string>
 #include <utility>
-#include <complex>
 #include <algorithm>
 #include <iterator>
 #include <stdexcept>
@@ -16,32 +15,58 @@
 
 namespace bignum {
 
-BigInt BigInt::pow(uint64_t exp) const {
-    // TODO: optimize pow for uint64_t exponent (binary powering, windowing, etc.)
-    if (exp == 0) return BigInt(1);
-    if (is_zero()) return BigInt(0);
-    BigInt result(1);
-    for (uint64_t i = 0; i < exp; ++i) {
-        result *= *this;
+size_t pow_window_bits(size_t exp_bits) {
+    if (exp_bits > 671) return 6;
+    if (exp_bits > 239) return 5;
+    if (exp_bits > 79) return 4;
+    if (exp_bits > 23) return 3;
+    return 1;
+}
+
+namespace {
+
+// Скользящее окно слева направо. bit_at(i) — i-й бит показателя, exp_bits > 0.
+// Знак получается сам: нечётные степени отрицательного основания отрицательны, квадраты — нет.
+template <class BitAt>
+BigInt sliding_window_pow(const BigInt& base, size_t exp_bits, BitAt bit_at) {
+    const size_t w = pow_window_bits(exp_bits);
+    // odd[i] = base^(2i+1)
+    std::vector<BigInt> odd(size_t(1) << (w - 1));
+    odd[0] = base;
+    if (odd.size() > 1) {
+        const BigInt base2 = base.sqr();
+        for (size_t i = 1; i < odd.size(); ++i) odd[i] = odd[i - 1] * base2;
     }
-    // Корректируем знак для нечётных exp
-    if (is_negative_ && (exp & 1)) result.is_negative_ = true;
+    // pos — сколько младших бит показателя ещё не учтено
+    BigInt result;
+    bool started = false;
+    size_t pos = exp_bits;
+    for_each_pow_window(exp_bits, w, bit_at, [&](size_t low, size_t digit) {
+        if (started) {
+            for (; pos > low; --pos) result = result.sqr();
+            result *= odd[digit >> 1];
+        } else {
+            result = odd[digit >> 1];
+            started = true;
+        }
+        pos = low;
+    });
+    for (; pos > 0; --pos) result = result.sqr();
     return result;
 }
 
+} // namespace
+
+BigInt BigInt::pow(uint64_t exp) const {
+    if (exp == 0) return BigInt(1);
+    const size_t bits = 64 - __builtin_clzll(exp);
+    return sliding_window_pow(*this, bits, [exp](size_t i) { return (exp >> i) & 1; });
+}
+
 BigInt BigInt::pow(const BigInt& exp) const {
-    // TODO: optimize pow for BigInt exponent (binary powering, windowing, etc.)
     if (exp.is_negative()) throw std::invalid_argument("Negative exponent not supported");
     if (exp.is_zero()) return BigInt(1);
-    BigInt result(1);
-    BigInt i(0);
-    while (i < exp) {
-        result *= *this;
-        i += BigInt(1);
-    }
-    // Корректируем знак для нечётных exp
-    if (is_negative_ && (exp.limbs_[0] & 1)) result.is_negative_ = true;
-    return result;
+    return sliding_window_pow(*this, exp.bit_length(), [&exp](size_t i) { return exp.test_bit(i); });
 }
 
 size_t BigInt::log2() const {
@@ -113,10 +138,9 @@ void BigInt::from_hex_string(const std::string& hex_str) {
     const size_t chars_per_limb = sizeof(uint64_t) * 2;
     const size_t num_limbs = (hex_str.length() + chars_per_limb - 1) / chars_per_limb;
 
-    capacity_ = num_limbs;
+    reallocate(num_limbs);
     size_ = num_limbs;
-    limbs_ = std::make_unique<uint64_t[]>(capacity_);
-    std::fill(limbs_.get(), limbs_.get() + capacity_, 0);
+    std::fill(limbs_, limbs_ + size_, 0);
 
     for (size_t i = 0; i < hex_str.length(); ++i) {
         size_t rev_idx = hex_str.length() - 1 - i;
@@ -131,95 +155,107 @@ void BigInt::from_dec_string(const std::string& dec_str) {
     if (dec_str.empty() || std::all_of(dec_str.begin(), dec_str.end(), [](char c){ return c == '0'; })) {
         return;
     }
-
-    BigInt ten(10);
-    for (char c : dec_str) {
-        uint8_t digit = dec_char_to_val(c);
-        *this *= ten;
-        *this += BigInt(digit);
-    }
+    *this = from_dec_recursive(dec_str.data(), dec_str.size());
 }
 
 BigInt::BigInt(int64_t val) {
     if (val == 0) return;
     if (val < 0) {
         is_negative_ = true;
-        limbs_ = std::make_unique<uint64_t[]>(1);
         limbs_[0] = static_cast<uint64_t>(-(val + 1)) + 1;
     } else {
         is_negative_ = false;
-        limbs_ = std::make_unique<uint64_t[]>(1);
         limbs_[0] = static_cast<uint64_t>(val);
     }
     size_ = 1;
-    capacity_ = 1;
 }
 
 BigInt::BigInt(size_t num_limbs, bool zero_initialize)
-    : limbs_(nullptr), size_(num_limbs), capacity_(num_limbs), is_negative_(false) {
-    if (capacity_ > 0) {
-        limbs_ = std::make_unique<uint64_t[]>(capacity_);
-        if (zero_initialize) {
-            std::fill(limbs_.get(), limbs_.get() + capacity_, 0);
-        }
+    : size_(num_limbs), is_negative_(false) {
+    reallocate(num_limbs);
+    if (zero_initialize) {
+        std::fill(limbs_, limbs_ + capacity_, 0);
     }
 }
 
 BigInt::BigInt(const BigInt& other)
-    : size_(other.size_), capacity_(other.size_), is_negative_(other.is_negative_) {
-    if (capacity_ > 0) {
-        limbs_ = std::make_unique<uint64_t[]>(capacity_);
-        std::copy(other.limbs_.get(), other.limbs_.get() + size_, limbs_.get());
-    }
+    : size_(other.size_), is_negative_(other.is_negative_) {
+    reallocate(other.size_);
+    std::copy(other.limbs_, other.limbs_ + size_, limbs_);
 }
 
 BigInt& BigInt::operator=(const BigInt& other) {
     if (this == &other) return *this;
     if (capacity_ < other.size_) {
-        limbs_ = std::make_unique<uint64_t[]>(other.size_);
-        capacity_ = other.size_;
+        reallocate(other.size_);
     }
     size_ = other.size_;
     is_negative_ = other.is_negative_;
-    if (size_ > 0) {
-        std::copy(other.limbs_.get(), other.limbs_.get() + size_, limbs_.get());
-    }
+    std::copy(other.limbs_, other.limbs_ + size_, limbs_);
     return *this;
 }
 
 BigInt::BigInt(BigInt&& other) noexcept
-    : limbs_(std::move(other.limbs_)),
-      size_(other.size_),
-      capacity_(other.capacity_),
+    : size_(other.size_),
       is_negative_(other.is_negative_) {
+    if (other.heap_) {
+        heap_ = std::move(other.heap_);
+        limbs_ = heap_.get();
+        capacity_ = other.capacity_;
+    } else {
+        std::copy(other.limbs_, other.limbs_ + size_, inline_);
+    }
+    other.limbs_ = other.inline_;
     other.size_ = 0;
-    other.capacity_ = 0;
+    other.capacity_ = INLINE_LIMBS;
     other.is_negative_ = false;
 }
 
 BigInt& BigInt::operator=(BigInt&& other) noexcept {
     if (this == &other) return *this;
-    limbs_ = std::move(other.limbs_);
+    if (other.heap_) {
+        heap_ = std::move(other.heap_);
+        limbs_ = heap_.get();
+        capacity_ = other.capacity_;
+    } else {
+        // other хранится inline, а ёмкость не бывает меньше INLINE_LIMBS — свой буфер не освобождаем
+        std::copy(other.limbs_, other.limbs_ + other.size_, limbs_);
+    }
     size_ = other.size_;
-    capacity_ = other.capacity_;
     is_negative_ = other.is_negative_;
+    other.limbs_ = other.inline_;
     other.size_ = 0;
-    other.capacity_ = 0;
+    other.capacity_ = INLINE_LIMBS;
     other.is_negative_ = false;
     return *this;
 }
 
+void BigInt::reallocate(size_t new_capacity) {
+    if (new_capacity <= INLINE_LIMBS) {
+        heap_.reset();
+        limbs_ = inline_;
+        capacity_ = INLINE_LIMBS;
+    } else {
+        heap_.reset(new uint64_t[new_capacity]);
+        limbs_ = heap_.get();
+        capacity_ = new_capacity;
+    }
+}
 
 void BigInt::resize(size_t new_capacity) {
     if (new_capacity <= capacity_) return;
-    auto new_limbs = std::make_unique<uint64_t[]>(new_capacity);
-    if(size_ > 0) {
-        std::copy(limbs_.get(), limbs_.get() + size_, new_limbs.get());
-    }
-    limbs_ = std::move(new_limbs);
+    std::unique_ptr<uint64_t[]> new_limbs(new uint64_t[new_capacity]);
+    std::copy(limbs_, limbs_ + size_, new_limbs.get());
+    heap_ = std::move(new_limbs);
+    limbs_ = heap_.get();
     capacity_ = new_capacity;
 }
 
+void BigInt::grow(size_t min_capacity) {
+    if (min_capacity <= capacity_) return;
+    resize(std::max(min_capacity, capacity_ + capacity_ / 2));
+}
+
 void BigInt::strip_leading_zeros() {
     while (size_ > 0 && limbs_[size_ - 1] == 0) {
         size_--;
@@ -277,23 +313,117 @@ BigInt BigInt::subtract_magnitude(const BigInt& a, const BigInt& b) {
     return result;
 }
 
+namespace {
+
+// (hi:lo) / d, требуется hi < d
+inline uint64_t div_128_by_64(uint64_t hi, uint64_t lo, uint64_t d, uint64_t& rem) {
+#if defined(__x86_64__)
+    uint64_t q;
+    __asm__("divq %4" : "=a"(q), "=d"(rem) : "a"(lo), "d"(hi), "rm"(d));
+    return q;
+#else
+    unsigned __int128 num = ((unsigned __int128)hi << 64) | lo;
+    rem = (uint64_t)(num % d);
+    return (uint64_t)(num / d);
+#endif
+}
+
+// Деление на один limb: q = u / d (q может совпадать с u), возвращает остаток
+uint64_t divmod_limb(const uint64_t* u, size_t n, uint64_t d, uint64_t* q) {
+    uint64_t rem = 0;
+    for (size_t i = n; i > 0; --i) {
+        q[i - 1] = div_128_by_64(rem, u[i - 1], d, rem);
+    }
+    return rem;
+}
+
+// Алгоритм D Кнута (TAOCP 4.3.1): u (m limb-ов) / v (n limb-ов), m >= n >= 2, v[n-1] != 0.
+// q получает m - n + 1 limb-ов, r — n limb-ов.
+void divmod_knuth(const uint64_t* u, size_t m, const uint64_t* v, size_t n, uint64_t* q, uint64_t* r) {
+    // Нормализация: старший бит делителя должен быть установлен
+    const int s = __builtin_clzll(v[n - 1]);
+    std::vector<uint64_t> vn(n), un(m + 1);
+    for (size_t i = n - 1; i > 0; --i) {
+        vn[i] = s ? (v[i] << s) | (v[i - 1] >> (64 - s)) : v[i];
+    }
+    vn[0] = v[0] << s;
+    un[m] = s ? u[m - 1] >> (64 - s) : 0;
+    for (size_t i = m - 1; i > 0; --i) {
+        un[i] = s ? (u[i] << s) | (u[i - 1] >> (64 - s)) : u[i];
+    }
+    un[0] = u[0] << s;
+
+    const uint64_t v_hi = vn[n - 1];
+    const uint64_t v_next = vn[n - 2];
+    for (size_t j = m - n + 1; j > 0; --j) {
+        const size_t jj = j - 1;
+        // Оценка частного по двум старшим limb-ам остатка
+        uint64_t qhat, rhat;
+        bool rhat_overflow = false;
+        if (un[jj + n] >= v_hi) {
+            qhat = ~0ULL;
+            rhat = un[jj + n - 1] + v_hi;
+            rhat_overflow = rhat < v_hi;
+        } else {
+            qhat = div_128_by_64(un[jj + n], un[jj + n - 1], v_hi, rhat);
+        }
+        while (!rhat_overflow &&
+               (unsigned __int128)qhat * v_next > (((unsigned __int128)rhat << 64) | un[jj + n - 2])) {
+            --qhat;
+            rhat += v_hi;
+            rhat_overflow = rhat < v_hi;
+        }
+
+        // un[jj..jj+n] -= qhat * vn
+        uint64_t carry = 0;
+        for (size_t i = 0; i < n; ++i) {
+            unsigned __int128 p = (unsigned __int128)qhat * vn[i] + carry;
+            uint64_t plo = (uint64_t)p;
+            carry = (uint64_t)(p >> 64) + (un[i + jj] < plo);
+            un[i + jj] -= plo;
+        }
+        const bool negative = un[jj + n] < carry;
+        un[jj + n] -= carry;
+
+        // Оценка оказалась на единицу больше: добавляем делитель обратно
+        if (negative) {
+            --qhat;
+            unsigned char c = 0;
+            for (size_t i = 0; i < n; ++i) {
+                c = _addcarry_u64(c, un[i + jj], vn[i], reinterpret_cast<unsigned long long*>(&un[i + jj]));
+            }
+            un[jj + n] += c;
+        }
+        q[jj] = qhat;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        r[i] = s ? (un[i] >> s) | (un[i + 1] << (64 - s)) : un[i];
+    }
+}
+
+} // namespace
+
+// Знаки операндов игнорируются: возвращаются неотрицательные частное и остаток от деления модулей
 std::pair<BigInt, BigInt> BigInt::div_mod_magnitude(const BigInt& dividend, const BigInt& divisor) {
     if (divisor.is_zero()) throw std::runtime_error("Division by zero (magnitude).");
     if (dividend.compare_magnitude(divisor) < 0) {
-        return {BigInt(int64_t(0)), dividend};
-    }
-    BigInt quotient(int64_t(0));
-    BigInt remainder = dividend;
-    size_t initial_shift = dividend.bit_length() - divisor.bit_length();
-    BigInt temp_divisor = divisor << initial_shift;
-    for(size_t i = 0; i <= initial_shift; ++i) {
-        if (remainder.compare_magnitude(temp_divisor) >= 0) {
-            remainder -= temp_divisor;
-            quotient |= (BigInt(int64_t(1)) << (initial_shift - i));
-        }
-        temp_divisor >>= 1;
+        return {BigInt(int64_t(0)), dividend.abs()};
+    }
+    const size_t m = dividend.size_;
+    const size_t n = divisor.size_;
+    BigInt quotient(m - n + 1, false);
+    BigInt remainder;
+    if (n == 1) {
+        uint64_t rem = divmod_limb(dividend.limbs_, m, divisor.limbs_[0], quotient.limbs_);
+        remainder = from_limbs(&rem, 1);
+    } else {
+        remainder = BigInt(n, false);
+        divmod_knuth(dividend.limbs_, m, divisor.limbs_, n, quotient.limbs_, remainder.limbs_);
     }
-    return {quotient, remainder};
+    quotient.strip_leading_zeros();
+    remainder.strip_leading_zeros();
+    return {std::move(quotient), std::move(remainder)};
 }
 
 
@@ -323,246 +453,724 @@ BigInt BigInt::operator+(const BigInt& other) const {
         }
     }
 }
-BigInt& BigInt::operator+=(const BigInt& other) { *this = *this + other; return *this; }
+BigInt& BigInt::operator+=(const BigInt& other) { add_signed_inplace(other, other.is_negative_); return *this; }
+
+BigInt BigInt::operator-(const BigInt& other) const { BigInt result = *this; result -= other; return result; }
+BigInt& BigInt::operator-=(const BigInt& other) { add_signed_inplace(other, !other.is_negative_ && !other.is_zero()); return *this; }
 
-BigInt BigInt::operator-(const BigInt& other) const { return *this + (-other); }
-BigInt& BigInt::operator-=(const BigInt& other) { *this = *this - other; return *this; }
+void BigInt::add_signed_inplace(const BigInt& other, bool other_negative) {
+    if (other.is_zero()) return;
+    if (is_zero()) {
+        // other может совпадать с *this только если *this ненулевой
+        *this = other;
+        is_negative_ = other_negative;
+        return;
+    }
+    if (is_negative_ == other_negative) {
+        add_magnitude_inplace(other);
+        return;
+    }
+    int mag_cmp = compare_magnitude(other);
+    if (mag_cmp == 0) {
+        size_ = 0;
+        is_negative_ = false;
+    } else if (mag_cmp > 0) {
+        sub_magnitude_inplace(other);
+    } else {
+        rsub_magnitude_inplace(other);
+        is_negative_ = other_negative;
+    }
+}
+
+void BigInt::add_magnitude_inplace(const BigInt& other) {
+    const size_t n = std::max(size_, other.size_);
+    grow(n + 1);
+    // other может совпадать с *this: limbs_ читается и пишется по одному индексу
+    std::fill(limbs_ + size_, limbs_ + n, 0);
+    unsigned char carry = 0;
+    size_t i = 0;
+    for (; i < other.size_; ++i) {
+        carry = _addcarry_u64(carry, limbs_[i], other.limbs_[i], reinterpret_cast<unsigned long long*>(&limbs_[i]));
+    }
+    for (; carry && i < n; ++i) {
+        carry = _addcarry_u64(carry, limbs_[i], 0, reinterpret_cast<unsigned long long*>(&limbs_[i]));
+    }
+    size_ = n;
+    if (carry) limbs_[size_++] = 1;
+}
+
+void BigInt::sub_magnitude_inplace(const BigInt& other) {
+    unsigned char borrow = 0;
+    size_t i = 0;
+    for (; i < other.size_; ++i) {
+        borrow = _subborrow_u64(borrow, limbs_[i], other.limbs_[i], reinterpret_cast<unsigned long long*>(&limbs_[i]));
+    }
+    for (; borrow && i < size_; ++i) {
+        borrow = _subborrow_u64(borrow, limbs_[i], 0, reinterpret_cast<unsigned long long*>(&limbs_[i]));
+    }
+    strip_leading_zeros();
+}
+
+void BigInt::rsub_magnitude_inplace(const BigInt& other) {
+    grow(other.size_);
+    std::fill(limbs_ + size_, limbs_ + other.size_, 0);
+    unsigned char borrow = 0;
+    for (size_t i = 0; i < other.size_; ++i) {
+        borrow = _subborrow_u64(borrow, other.limbs_[i], limbs_[i], reinterpret_cast<unsigned long long*>(&limbs_[i]));
+    }
+    size_ = other.size_;
+    strip_leading_zeros();
+}
+
+void BigInt::mul_limb_inplace(uint64_t m) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < size_; ++i) {
+        unsigned __int128 cur = (unsigned __int128)limbs_[i] * m + carry;
+        limbs_[i] = (uint64_t)cur;
+        carry = (uint64_t)(cur >> 64);
+    }
+    if (carry) {
+        grow(size_ + 1);
+        limbs_[size_++] = carry;
+    }
+    strip_leading_zeros();
+}
 
 namespace {
-#include <cmath>
-#include <complex>
 
-constexpr size_t FFT_THRESHOLD = 1000000; // временно увеличено для диагностики fft_mul
+constexpr size_t NTT_THRESHOLD = 16000; // по limb-ам меньшего операнда
+
+// Арифметика по простому модулю p < 2^62 в форме Монтгомери (R = 2^64)
+struct NttField {
+    uint64_t p;
+    uint64_t p_neg_inv; // -p^{-1} mod 2^64
+    uint64_t r2;        // R^2 mod p
+    uint64_t g;         // первообразный корень
+
+    explicit NttField(uint64_t prime, uint64_t root) : p(prime), g(root) {
+        uint64_t inv = 1;
+        for (int i = 0; i < 6; ++i) inv *= 2 - p * inv;
+        p_neg_inv = ~inv + 1;
+        unsigned __int128 r = ((unsigned __int128)1 << 64) % p;
+        r2 = (uint64_t)((r * r) % p);
+    }
+    uint64_t reduce(unsigned __int128 t) const {
+        uint64_t m = (uint64_t)t * p_neg_inv;
+        uint64_t u = (uint64_t)((t + (unsigned __int128)m * p) >> 64);
+        return u >= p ? u - p : u;
+    }
+    uint64_t mul(uint64_t a, uint64_t b) const { return reduce((unsigned __int128)a * b); }
+    uint64_t add(uint64_t a, uint64_t b) const { uint64_t s = a + b; return s >= p ? s - p : s; }
+    uint64_t sub(uint64_t a, uint64_t b) const { return a >= b ? a - b : a + p - b; }
+    uint64_t to_mont(uint64_t a) const { return mul(a % p, r2); }
+    uint64_t from_mont(uint64_t a) const { return reduce(a); }
+    uint64_t pow(uint64_t base_mont, uint64_t e) const {
+        uint64_t result = to_mont(1);
+        for (; e; e >>= 1) {
+            if (e & 1) result = mul(result, base_mont);
+            base_mont = mul(base_mont, base_mont);
+        }
+        return result;
+    }
+};
+
+// Три простых вида c*2^50 + 1: произведение > 2^185 покрывает коэффициенты свёртки
+// целых 64-битных limb-ов (< n * 2^128) при длине до 2^50, поэтому limb-ы не дробятся.
+const NttField& ntt_field(size_t i) {
+    static const NttField fields[3] = {
+        NttField(0x3fdc000000000001ULL, 3),
+        NttField(0x3f18000000000001ULL, 10),
+        NttField(0x3ec4000000000001ULL, 37),
+    };
+    return fields[i];
+}
+
+// Таблица корней по этапам: для этапа длины len корни w_len^j (j < len/2) лежат подряд в roots[len/2 + j].
+// w — корень степени n из 1 или обратный к нему.
+std::vector<uint64_t> ntt_roots(const NttField& f, size_t n, bool invert) {
+    uint64_t w = f.pow(f.to_mont(f.g), (f.p - 1) / n);
+    if (invert) w = f.pow(w, f.p - 2);
+    std::vector<uint64_t> roots(std::max<size_t>(n, 2));
+    const size_t half = n / 2;
+    roots[half] = f.to_mont(1);
+    for (size_t j = 1; j < half; ++j) roots[half + j] = f.mul(roots[half + j - 1], w);
+    for (size_t h = half / 2; h >= 1; h /= 2) {
+        for (size_t j = 0; j < h; ++j) roots[h + j] = roots[2 * h + 2 * j];
+    }
+    return roots;
+}
 
-// fft
-void fft(std::complex<double>* a, size_t n, bool invert) {
-    for (size_t i = 1, j = 0; i < n; ++i) {
-        size_t bit = n >> 1;
-        for (; j & bit; bit >>= 1) j ^= bit;
-        j ^= bit;
-        if (i < j) std::swap(a[i], a[j]);
+// Прямое преобразование (Gentleman–Sande): естественный порядок на входе, бит-реверсный на выходе
+void ntt_forward(uint64_t* a, size_t n, const NttField& f, const std::vector<uint64_t>& roots) {
+    for (size_t len = n; len >= 2; len >>= 1) {
+        const size_t half = len / 2;
+        const uint64_t* w = roots.data() + half;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = a[i + j], v = a[i + j + half];
+                a[i + j] = f.add(u, v);
+                a[i + j + half] = f.mul(f.sub(u, v), w[j]);
+            }
+        }
     }
+}
+
+// Обратное преобразование (Cooley–Tukey): бит-реверсный порядок на входе, естественный на выходе, без деления на n
+void ntt_inverse(uint64_t* a, size_t n, const NttField& f, const std::vector<uint64_t>& roots) {
     for (size_t len = 2; len <= n; len <<= 1) {
-        double ang = 2 * M_PI / len * (invert ? -1 : 1);
-        std::complex<double> wlen(cos(ang), sin(ang));
+        const size_t half = len / 2;
+        const uint64_t* w = roots.data() + half;
         for (size_t i = 0; i < n; i += len) {
-            std::complex<double> w(1);
-            for (size_t j = 0; j < len / 2; ++j) {
-                std::complex<double> u = a[i + j];
-                std::complex<double> v = a[i + j + len / 2] * w;
-                a[i + j] = u + v;
-                a[i + j + len / 2] = u - v;
-                w *= wlen;
+            for (size_t j = 0; j < half; ++j) {
+                uint64_t u = a[i + j], v = f.mul(a[i + j + half], w[j]);
+                a[i + j] = f.add(u, v);
+                a[i + j + half] = f.sub(u, v);
             }
         }
     }
-    if (invert) for (size_t i = 0; i < n; ++i) a[i] /= n;
 }
 
-// Умножение через FFT
-void fft_mul(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
-    size_t n = 1;
-    while (n < an + bn) n <<= 1;
-    std::unique_ptr<std::complex<double>[]> fa(new std::complex<double>[n]{});
-    std::unique_ptr<std::complex<double>[]> fb(new std::complex<double>[n]{});
-    for (size_t i = 0; i < an; ++i) fa[i] = (double)a[i];
-    for (size_t i = 0; i < bn; ++i) fb[i] = (double)b[i];
-    fft(fa.get(), n, false);
-    fft(fb.get(), n, false);
-    for (size_t i = 0; i < n; ++i) fa[i] *= fb[i];
-    fft(fa.get(), n, true);
-    // Собираем результат с переносами 
-    std::unique_ptr<uint64_t[]> res(new uint64_t[n]{});
-    double LIMB_BASE = 18446744073709551616.0; // 2^64
-    int64_t carry = 0;
-    for (size_t i = 0; i < n; ++i) {
-        double val = std::round(fa[i].real()) + carry;
-        carry = (int64_t)(val / LIMB_BASE);
-        res[i] = (uint64_t)(val - carry * LIMB_BASE);
+// Свёртка по одному модулю: residues[k] = (sum a_i b_{k-i}) mod p, обычная (не Монтгомери) форма.
+// При a == b выполняется возведение в квадрат.
+void ntt_convolve(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, size_t n,
+                  const NttField& f, std::vector<uint64_t>& residues) {
+    const bool square = a == b && an == bn;
+    std::vector<uint64_t> fa(n, 0);
+    for (size_t i = 0; i < an; ++i) fa[i] = f.to_mont(a[i]);
+    const std::vector<uint64_t> roots = ntt_roots(f, n, false);
+    ntt_forward(fa.data(), n, f, roots);
+    if (square) {
+        // Квадрат: достаточно одного прямого преобразования
+        for (size_t i = 0; i < n; ++i) fa[i] = f.mul(fa[i], fa[i]);
+    } else {
+        std::vector<uint64_t> fb(n, 0);
+        for (size_t i = 0; i < bn; ++i) fb[i] = f.to_mont(b[i]);
+        ntt_forward(fb.data(), n, f, roots);
+        for (size_t i = 0; i < n; ++i) fa[i] = f.mul(fa[i], fb[i]);
     }
-    for (size_t i = 0; i < n; ++i) out[i] = res[i];
+    ntt_inverse(fa.data(), n, f, ntt_roots(f, n, true));
+    // Деление на n и выход из формы Монтгомери одним умножением на обычное n^{-1}
+    const uint64_t n_inv = f.from_mont(f.pow(f.to_mont(n), f.p - 2));
+    residues.resize(an + bn - 1);
+    for (size_t i = 0; i < residues.size(); ++i) residues[i] = f.mul(fa[i], n_inv);
 }
+
+// Точное умножение через NTT по трём простым с восстановлением по КТО (схема Гарнера).
+// out[0, an+bn) = a * b; при a == b — квадрат с одним прямым преобразованием на модуль
+void ntt_mul(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
+    size_t n = 1;
+    while (n < an + bn - 1) n <<= 1;
+    const NttField& f1 = ntt_field(0);
+    const NttField& f2 = ntt_field(1);
+    const NttField& f3 = ntt_field(2);
+    std::vector<uint64_t> r1, r2, r3;
+    ntt_convolve(a, an, b, bn, n, f1, r1);
+    ntt_convolve(a, an, b, bn, n, f2, r2);
+    ntt_convolve(a, an, b, bn, n, f3, r3);
+
+    // Константы Гарнера в форме Монтгомери: mul(x, c) даёт x*c mod p для обычного x
+    const uint64_t inv_p1_p2 = f2.pow(f2.to_mont(f1.p), f2.p - 2);
+    const uint64_t inv_p1_p3 = f3.pow(f3.to_mont(f1.p), f3.p - 2);
+    const uint64_t inv_p2_p3 = f3.pow(f3.to_mont(f2.p), f3.p - 2);
+    const unsigned __int128 p1p2 = (unsigned __int128)f1.p * f2.p;
+    const uint64_t p1p2_lo = (uint64_t)p1p2, p1p2_hi = (uint64_t)(p1p2 >> 64);
+
+    const size_t out_n = an + bn;
+    std::fill(out, out + out_n, 0);
+    for (size_t i = 0; i < r1.size(); ++i) {
+        // x = v1 + v2*p1 + v3*p1*p2
+        const uint64_t v1 = r1[i];
+        // p1 > p2 > p3 и все три близки к 2^62, поэтому приведение — одно вычитание
+        const uint64_t v2 = f2.mul(f2.sub(r2[i], v1 >= f2.p ? v1 - f2.p : v1), inv_p1_p2);
+        const uint64_t v1_3 = v1 >= f3.p ? v1 - f3.p : v1;
+        const uint64_t v2_3 = v2 >= f3.p ? v2 - f3.p : v2;
+        const uint64_t v3 = f3.mul(f3.sub(f3.mul(f3.sub(r3[i], v1_3), inv_p1_p3), v2_3), inv_p2_p3);
+        unsigned __int128 t = (unsigned __int128)v2 * f1.p + v1;
+        unsigned __int128 lo = (unsigned __int128)v3 * p1p2_lo;
+        unsigned __int128 hi = (unsigned __int128)v3 * p1p2_hi;
+        uint64_t x[3];
+        unsigned __int128 acc = (uint64_t)t + (unsigned __int128)(uint64_t)lo;
+        x[0] = (uint64_t)acc;
+        acc = (acc >> 64) + (t >> 64) + (lo >> 64) + (uint64_t)hi;
+        x[1] = (uint64_t)acc;
+        x[2] = (uint64_t)(acc >> 64) + (uint64_t)(hi >> 64);
+
+        unsigned char carry = 0;
+        size_t j = 0;
+        for (; j < 3 && i + j < out_n; ++j) {
+            carry = _addcarry_u64(carry, out[i + j], x[j], reinterpret_cast<unsigned long long*>(&out[i + j]));
+        }
+        for (j += i; carry && j < out_n; ++j) {
+            carry = _addcarry_u64(carry, out[j], 0, reinterpret_cast<unsigned long long*>(&out[j]));
+        }
+    }
 }
 
+} // namespace
+
 constexpr size_t KARATSUBA_THRESHOLD = 32; // по limb-ам (64 бита)
+constexpr size_t KARATSUBA_SQR_THRESHOLD = 48; // школьное возведение в квадрат дешевле, порог выше
+constexpr size_t TOOM3_THRESHOLD = 160;    // по limb-ам меньшего операнда
+constexpr size_t TOOM4_THRESHOLD = 480;
 
 void schoolbook_mul(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out) {
     for (size_t i = 0; i < an + bn; ++i) out[i] = 0;
     for (size_t i = 0; i < an; ++i) {
         unsigned __int128 carry = 0;
-#if defined(__AVX2__)
-        if ((bn % 4 == 0) && ((uintptr_t)(b) % 32 == 0) && ((uintptr_t)(out + i) % 32 == 0)) {
-            __m256i a_vec = _mm256_set1_epi64x(a[i]);
-            size_t j = 0;
-            for (; j + 3 < bn; j += 4) {
-                __m256i b_vec = _mm256_load_si256((const __m256i*)(b + j));
-                __m256i out_vec = _mm256_load_si256((__m256i*)(out + i + j));
-                // Младшие 64 бита каждого lane: a[i] * b[j..j+3]
-                uint64_t tmp[4];
-                for (int k = 0; k < 4; ++k) tmp[k] = a[i] * b[j + k] + ((uint64_t*)&out_vec)[k];
-                for (int k = 0; k < 4; ++k) ((uint64_t*)&out_vec)[k] = tmp[k];
-                _mm256_store_si256((__m256i*)(out + i + j), out_vec);
-            }
-            // Остаток — обычным способом
-            for (; j < bn; ++j) {
-                unsigned __int128 product = (unsigned __int128)a[i] * b[j] + out[i + j] + carry;
-                out[i + j] = (uint64_t)product;
-                carry = product >> 64;
-            }
-        } else
-#endif
-        {
-            for (size_t j = 0; j < bn; ++j) {
-                unsigned __int128 product = (unsigned __int128)a[i] * b[j] + out[i + j] + carry;
-                out[i + j] = (uint64_t)product;
-                carry = product >> 64;
-            }
+        for (size_t j = 0; j < bn; ++j) {
+            unsigned __int128 product = (unsigned __int128)a[i] * b[j] + out[i + j] + carry;
+            out[i + j] = (uint64_t)product;
+            carry = product >> 64;
         }
         out[i + bn] += (uint64_t)carry;
     }
 }
 
-void karatsuba_mul(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out, uint64_t* buf) {
-    if (an <= KARATSUBA_THRESHOLD) {
-        schoolbook_mul(a, an, b, bn, out);
-        return;
+// out[0, 2n) = a^2: каждое произведение a_i*a_j (i < j) считается один раз,
+// сумма удваивается сдвигом, затем добавляются квадраты a_i^2 на диагонали.
+void schoolbook_sqr(const uint64_t* a, size_t n, uint64_t* out) {
+    std::fill(out, out + 2 * n, 0);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        unsigned __int128 carry = 0;
+        for (size_t j = i + 1; j < n; ++j) {
+            unsigned __int128 product = (unsigned __int128)a[i] * a[j] + out[i + j] + carry;
+            out[i + j] = (uint64_t)product;
+            carry = product >> 64;
+        }
+        out[i + n] = (uint64_t)carry;
+    }
+    uint64_t top = 0;
+    for (size_t i = 0; i < 2 * n; ++i) {
+        const uint64_t v = out[i];
+        out[i] = (v << 1) | top;
+        top = v >> 63;
+    }
+    unsigned char carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const unsigned __int128 sq = (unsigned __int128)a[i] * a[i];
+        carry = _addcarry_u64(carry, out[2 * i], (uint64_t)sq, reinterpret_cast<unsigned long long*>(&out[2 * i]));
+        carry = _addcarry_u64(carry, out[2 * i + 1], (uint64_t)(sq >> 64), reinterpret_cast<unsigned long long*>(&out[2 * i + 1]));
     }
-    size_t n = an;
-    size_t k = n / 2;
+}
+
+void mul_limbs(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out, uint64_t* scratch);
+void sqr_limbs(const uint64_t* a, size_t n, uint64_t* out, uint64_t* scratch);
+
+// Рабочая память для mul_limbs при an >= bn: на уровне Карацубы расходуется 4k+4 limb-а
+// (k = ceil(an/2)) плюс рекурсия для k+1, что в сумме не превышает 6*an + 64.
+size_t mul_scratch_limbs(size_t an) { return 6 * an + 64; }
+
+// sum[0, k] = lo[0, k) + hi[0, hi_n), hi_n <= k
+void add_halves(const uint64_t* lo, size_t k, const uint64_t* hi, size_t hi_n, uint64_t* sum) {
+    unsigned char c = 0;
+    size_t i = 0;
+    for (; i < hi_n; ++i) c = _addcarry_u64(c, lo[i], hi[i], reinterpret_cast<unsigned long long*>(&sum[i]));
+    for (; i < k; ++i) c = _addcarry_u64(c, lo[i], 0, reinterpret_cast<unsigned long long*>(&sum[i]));
+    sum[k] = c;
+}
+
+// Общий шаг Карацубы: out уже содержит z0 (2k limb-ов) и z2 (остаток до out_n),
+// z1 (2k+2 limb-а) — произведение сумм половин. out += (z1 - z0 - z2) << (k*64).
+void karatsuba_combine(uint64_t* out, size_t out_n, size_t k, uint64_t* z1) {
+    // z1 -= z0, z1 -= z2 (результат неотрицателен)
+    const uint64_t* z0 = out;
+    const uint64_t* z2 = out + 2 * k;
+    const size_t z2n = out_n - 2 * k;
+    unsigned char br = 0;
+    size_t i = 0;
+    for (; i < 2 * k; ++i) br = _subborrow_u64(br, z1[i], z0[i], reinterpret_cast<unsigned long long*>(&z1[i]));
+    for (; i < 2 * k + 2; ++i) br = _subborrow_u64(br, z1[i], 0, reinterpret_cast<unsigned long long*>(&z1[i]));
+    br = 0;
+    for (i = 0; i < z2n; ++i) br = _subborrow_u64(br, z1[i], z2[i], reinterpret_cast<unsigned long long*>(&z1[i]));
+    for (; i < 2 * k + 2; ++i) br = _subborrow_u64(br, z1[i], 0, reinterpret_cast<unsigned long long*>(&z1[i]));
+
+    // out += z1 << (k*64); старшие limb-ы z1 за пределами out равны нулю
+    const size_t z1n = std::min(2 * k + 2, out_n - k);
+    unsigned char carry = 0;
+    for (i = 0; i < z1n; ++i) {
+        carry = _addcarry_u64(carry, out[i + k], z1[i], reinterpret_cast<unsigned long long*>(&out[i + k]));
+    }
+    for (i += k; carry && i < out_n; ++i) {
+        carry = _addcarry_u64(carry, out[i], 0, reinterpret_cast<unsigned long long*>(&out[i]));
+    }
+}
+
+// Карацуба для an >= bn > ceil(an/2): a = a1*B^k + a0, b = b1*B^k + b0.
+// z0 и z2 считаются сразу в out, z1 = (a0+a1)(b0+b1) - z0 - z2 — в scratch.
+void karatsuba_mul(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out, uint64_t* scratch) {
+    const size_t k = (an + 1) / 2;
+    const size_t a1n = an - k;
+    const size_t b1n = bn - k;
+    const size_t out_n = an + bn;
     const uint64_t* a0 = a;
     const uint64_t* a1 = a + k;
     const uint64_t* b0 = b;
     const uint64_t* b1 = b + k;
-    uint64_t* z0 = buf;
-    uint64_t* z1 = buf + 2 * k;
-    uint64_t* z2 = buf + 4 * k;
-    // z0 = a0 * b0
-    schoolbook_mul(a0, k, b0, k, z0);
-    // z2 = a1 * b1
-    schoolbook_mul(a1, k, b1, k, z2);
-    // (a0+a1), (b0+b1)
-    uint64_t* a_sum = buf + 6 * k;
-    uint64_t* b_sum = buf + 7 * k;
-    for (size_t i = 0; i < k; ++i) {
-        a_sum[i] = a0[i] + a1[i];
-        b_sum[i] = b0[i] + b1[i];
-    }
-    // z1 = (a0+a1)*(b0+b1)
-    schoolbook_mul(a_sum, k, b_sum, k, z1);
-    // z1 = z1 - z0 - z2
-    for (size_t i = 0; i < 2 * k; ++i) {
-        uint64_t t = z1[i];
-        t -= z0[i];
-        t -= z2[i];
-        z1[i] = t;
-    }
-    // out = z0 + (z1 << (k*64)) + (z2 << (2*k*64))
-    for (size_t i = 0; i < 2 * n; ++i) out[i] = 0;
-    // Сложение с переносом для out += z0, z1, z2
-    unsigned __int128 carry = 0;
-    for (size_t i = 0; i < 2 * k; ++i) {
-        unsigned __int128 sum = (unsigned __int128)out[i] + z0[i] + carry;
-        out[i] = (uint64_t)sum;
-        carry = sum >> 64;
-    }
-    // propagate carry
-    for (size_t i = 2 * k; carry && i < 2 * n; ++i) {
-        unsigned __int128 sum = (unsigned __int128)out[i] + carry;
-        out[i] = (uint64_t)sum;
-        carry = sum >> 64;
-    }
-
-    carry = 0;
-    for (size_t i = 0; i < 2 * k; ++i) {
-        unsigned __int128 sum = (unsigned __int128)out[i + k] + z1[i] + carry;
-        out[i + k] = (uint64_t)sum;
-        carry = sum >> 64;
-    }
-    for (size_t i = 2 * k + k; carry && i < 2 * n; ++i) {
-        unsigned __int128 sum = (unsigned __int128)out[i] + carry;
-        out[i] = (uint64_t)sum;
-        carry = sum >> 64;
-    }
-
-    carry = 0;
-    for (size_t i = 0; i < 2 * k; ++i) {
-        unsigned __int128 sum = (unsigned __int128)out[i + 2 * k] + z2[i] + carry;
-        out[i + 2 * k] = (uint64_t)sum;
-        carry = sum >> 64;
-    }
-    for (size_t i = 2 * k + 2 * k; carry && i < 2 * n; ++i) {
-        unsigned __int128 sum = (unsigned __int128)out[i] + carry;
-        out[i] = (uint64_t)sum;
-        carry = sum >> 64;
+
+    // z0 = a0*b0 -> out[0, 2k), z2 = a1*b1 -> out[2k, an+bn)
+    mul_limbs(a0, k, b0, k, out, scratch);
+    mul_limbs(a1, a1n, b1, b1n, out + 2 * k, scratch);
+
+    uint64_t* a_sum = scratch;              // k + 1 limb
+    uint64_t* b_sum = scratch + k + 1;      // k + 1 limb
+    uint64_t* z1 = scratch + 2 * k + 2;     // 2k + 2 limb-а
+    uint64_t* rest = scratch + 4 * k + 4;
+    add_halves(a0, k, a1, a1n, a_sum);
+    add_halves(b0, k, b1, b1n, b_sum);
+    mul_limbs(a_sum, k + 1, b_sum, k + 1, z1, rest);
+
+    karatsuba_combine(out, out_n, k, z1);
+}
+
+// Карацуба для квадрата: z1 = (a0+a1)^2 - z0 - z2, все три произведения — квадраты
+void karatsuba_sqr(const uint64_t* a, size_t n, uint64_t* out, uint64_t* scratch) {
+    const size_t k = (n + 1) / 2;
+    const size_t a1n = n - k;
+    sqr_limbs(a, k, out, scratch);
+    sqr_limbs(a + k, a1n, out + 2 * k, scratch);
+
+    uint64_t* a_sum = scratch;              // k + 1 limb
+    uint64_t* z1 = scratch + k + 1;         // 2k + 2 limb-а
+    uint64_t* rest = scratch + 3 * k + 3;
+    add_halves(a, k, a + k, a1n, a_sum);
+    sqr_limbs(a_sum, k + 1, z1, rest);
+
+    karatsuba_combine(out, 2 * n, k, z1);
+}
+
+// Несбалансированные операнды (an >= 2*bn): a режется на куски по bn limb-ов, каждый кусок
+// умножается на b сбалансированно и добавляется в out со сдвигом. mul_chunk(chunk, len, prod)
+// пишет произведение куска на b в prod[0, len+bn); prod — буфер на 2*bn limb-ов.
+template <class MulChunk>
+void chunked_mul(const uint64_t* a, size_t an, size_t bn, uint64_t* out, uint64_t* prod, MulChunk mul_chunk) {
+    std::fill(out, out + an + bn, 0);
+    for (size_t off = 0; off < an; off += bn) {
+        const size_t len = std::min(bn, an - off);
+        mul_chunk(a + off, len, prod);
+        unsigned char carry = 0;
+        size_t i = 0;
+        for (; i < len + bn; ++i) {
+            carry = _addcarry_u64(carry, out[off + i], prod[i], reinterpret_cast<unsigned long long*>(&out[off + i]));
+        }
+        for (i += off; carry && i < an + bn; ++i) {
+            carry = _addcarry_u64(carry, out[i], 0, reinterpret_cast<unsigned long long*>(&out[i]));
+        }
+    }
+}
+
+// out[0, an+bn) = a * b; out не должен пересекаться с a и b
+void mul_limbs(const uint64_t* a, size_t an, const uint64_t* b, size_t bn, uint64_t* out, uint64_t* scratch) {
+    if (an < bn) {
+        std::swap(a, b);
+        std::swap(an, bn);
+    }
+    if (bn <= KARATSUBA_THRESHOLD) {
+        schoolbook_mul(a, an, b, bn, out);
+    } else if (bn <= (an + 1) / 2) {
+        uint64_t* rest = scratch + 2 * bn;
+        chunked_mul(a, an, bn, out, scratch, [&](const uint64_t* chunk, size_t len, uint64_t* prod) {
+            mul_limbs(chunk, len, b, bn, prod, rest);
+        });
+    } else {
+        karatsuba_mul(a, an, b, bn, out, scratch);
+    }
+}
+
+// out[0, 2n) = a^2; out не должен пересекаться с a, scratch — mul_scratch_limbs(n)
+void sqr_limbs(const uint64_t* a, size_t n, uint64_t* out, uint64_t* scratch) {
+    if (n <= KARATSUBA_SQR_THRESHOLD) {
+        schoolbook_sqr(a, n, out);
+    } else {
+        karatsuba_sqr(a, n, out, scratch);
+    }
+}
+
+BigInt BigInt::slice_limbs(size_t from, size_t count) const {
+    if (from >= size_) return BigInt(int64_t(0));
+    count = std::min(count, size_ - from);
+    BigInt result(count, false);
+    std::copy(limbs_ + from, limbs_ + from + count, result.limbs_);
+    result.strip_leading_zeros();
+    return result;
+}
+
+void BigInt::add_magnitude_at(const BigInt& other, size_t limb_offset) {
+    if (other.is_zero()) return;
+    const size_t n = std::max(size_, other.size_ + limb_offset);
+    grow(n + 1);
+    std::fill(limbs_ + size_, limbs_ + n + 1, 0);
+    unsigned char carry = 0;
+    size_t i = 0;
+    for (; i < other.size_; ++i) {
+        carry = _addcarry_u64(carry, limbs_[i + limb_offset], other.limbs_[i], reinterpret_cast<unsigned long long*>(&limbs_[i + limb_offset]));
+    }
+    for (i += limb_offset; carry; ++i) {
+        carry = _addcarry_u64(carry, limbs_[i], 0, reinterpret_cast<unsigned long long*>(&limbs_[i]));
+    }
+    size_ = n + 1;
+    strip_leading_zeros();
+}
+
+// Тоом-3 (точки 0, 1, -1, -2, inf), интерполяция по последовательности Бодрато
+BigInt BigInt::toom3_mul(const BigInt& a, const BigInt& b) {
+    const size_t k = (std::max(a.size_, b.size_) + 2) / 3;
+    const BigInt a0 = a.slice_limbs(0, k), a1 = a.slice_limbs(k, k), a2 = a.slice_limbs(2 * k, k);
+    const BigInt b0 = b.slice_limbs(0, k), b1 = b.slice_limbs(k, k), b2 = b.slice_limbs(2 * k, k);
+
+    // Значения в точках: p(1), p(-1), p(-2)
+    auto evaluate = [](const BigInt& x0, const BigInt& x1, const BigInt& x2, BigInt& v1, BigInt& vm1, BigInt& vm2) {
+        BigInt t = x0 + x2;
+        v1 = t + x1;
+        vm1 = t - x1;
+        vm2 = vm1 + x2;
+        vm2 <<= 1;
+        vm2 -= x0;
+    };
+    BigInt a_1, a_m1, a_m2, b_1, b_m1, b_m2;
+    evaluate(a0, a1, a2, a_1, a_m1, a_m2);
+    // При a == b (возведение в квадрат) вторая оценка не нужна, произведения в точках — квадраты
+    const bool square = &a == &b;
+    if (!square) evaluate(b0, b1, b2, b_1, b_m1, b_m2);
+    auto point_mul = [square](const BigInt& x, const BigInt& y) { return square ? x.sqr() : x * y; };
+
+    BigInt r0 = point_mul(a0, b0);
+    BigInt r1 = point_mul(a_1, b_1);
+    BigInt rm1 = point_mul(a_m1, b_m1);
+    BigInt rm2 = point_mul(a_m2, b_m2);
+    BigInt rinf = point_mul(a2, b2);
+
+    // Коэффициенты r0 + c1 x + c2 x^2 + c3 x^3 + rinf x^4. Все деления точные,
+    // поэтому сдвиг модуля отрицательного числа тоже даёт точное частное.
+    BigInt c3 = rm2 - r1;
+    c3 /= BigInt(3);
+    BigInt c1 = r1 - rm1;
+    c1 >>= 1;
+    BigInt c2 = rm1 - r0;
+    c3 = c2 - c3;
+    c3 >>= 1;
+    c3 += rinf << 1;
+    c2 += c1;
+    c2 -= rinf;
+    c1 -= c3;
+
+    BigInt result = r0;
+    result.add_magnitude_at(c1, k);
+    result.add_magnitude_at(c2, 2 * k);
+    result.add_magnitude_at(c3, 3 * k);
+    result.add_magnitude_at(rinf, 4 * k);
+    return result;
+}
+
+// Тоом-4 (точки 0, 1, -1, 2, -2, 1/2, inf)
+BigInt BigInt::toom4_mul(const BigInt& a, const BigInt& b) {
+    const size_t k = (std::max(a.size_, b.size_) + 3) / 4;
+    BigInt ap[4], bp[4];
+    for (size_t i = 0; i < 4; ++i) {
+        ap[i] = a.slice_limbs(i * k, k);
+        bp[i] = b.slice_limbs(i * k, k);
+    }
+    // p(1), p(-1), p(2), p(-2), 8*p(1/2)
+    auto evaluate = [](const BigInt* x, BigInt* v) {
+        BigInt even = x[0] + x[2];
+        BigInt odd = x[1] + x[3];
+        v[0] = even + odd;
+        v[1] = even - odd;
+        BigInt even2 = x[0] + (x[2] << 2);
+        BigInt odd2 = (x[1] << 1) + (x[3] << 3);
+        v[2] = even2 + odd2;
+        v[3] = even2 - odd2;
+        v[4] = (x[0] << 3) + (x[1] << 2) + (x[2] << 1) + x[3];
+    };
+    BigInt av[5], bv[5];
+    evaluate(ap, av);
+    const bool square = &a == &b;
+    if (!square) evaluate(bp, bv);
+    auto point_mul = [square](const BigInt& x, const BigInt& y) { return square ? x.sqr() : x * y; };
+
+    const BigInt c0 = point_mul(ap[0], bp[0]);
+    const BigInt c6 = point_mul(ap[3], bp[3]);
+    const BigInt r1 = point_mul(av[0], bv[0]);
+    const BigInt rm1 = point_mul(av[1], bv[1]);
+    const BigInt r2 = point_mul(av[2], bv[2]);
+    const BigInt rm2 = point_mul(av[3], bv[3]);
+    const BigInt rh = point_mul(av[4], bv[4]); // 64 * c(1/2)
+
+    // Чётная часть: c2 + c4 и c2 + 4*c4
+    BigInt e1 = r1 + rm1;
+    e1 >>= 1;
+    e1 -= c0;
+    e1 -= c6;
+    BigInt e2 = r2 + rm2;
+    e2 >>= 1;
+    e2 -= c0;
+    e2 -= c6 << 6;
+    e2 >>= 2;
+    BigInt c4 = e2 - e1;
+    c4 /= BigInt(3);
+    BigInt c2 = e1 - c4;
+
+    // Нечётная часть: o1 = c1+c3+c5, o2 = c1+4c3+16c5, t = 16c1+4c3+c5
+    BigInt o1 = r1 - rm1;
+    o1 >>= 1;
+    BigInt o2 = r2 - rm2;
+    o2 >>= 2;
+    BigInt t = rh - (c0 << 6) - (c2 << 4) - (c4 << 2) - c6;
+    t >>= 1;
+    BigInt u = o2 - o1;
+    u /= BigInt(3);              // c3 + 5c5
+    BigInt v = t - o1;
+    v /= BigInt(3);              // 5c1 + c3
+    BigInt w = u - v;
+    w /= BigInt(5);              // c5 - c1
+    BigInt c3 = o1 * BigInt(5) - u - v;
+    c3 /= BigInt(3);
+    BigInt c1_plus_c5 = o1 - c3;
+    BigInt c5 = c1_plus_c5 + w;
+    c5 >>= 1;
+    BigInt c1 = c1_plus_c5 - c5;
+
+    BigInt result = c0;
+    result.add_magnitude_at(c1, k);
+    result.add_magnitude_at(c2, 2 * k);
+    result.add_magnitude_at(c3, 3 * k);
+    result.add_magnitude_at(c4, 4 * k);
+    result.add_magnitude_at(c5, 5 * k);
+    result.add_magnitude_at(c6, 6 * k);
+    return result;
+}
+
+BigInt BigInt::sqr() const {
+    if (is_zero()) return BigInt(int64_t(0));
+    const size_t n = size_;
+    if (n >= NTT_THRESHOLD) {
+        BigInt result(2 * n, false);
+        ntt_mul(limbs_, n, limbs_, n, result.limbs_);
+        result.strip_leading_zeros();
+        return result;
+    }
+    if (n >= TOOM3_THRESHOLD) {
+        BigInt result = n >= TOOM4_THRESHOLD ? toom4_mul(*this, *this) : toom3_mul(*this, *this);
+        result.is_negative_ = false;
+        return result;
+    }
+    BigInt result(2 * n, false);
+    if (n <= KARATSUBA_SQR_THRESHOLD) {
+        schoolbook_sqr(limbs_, n, result.limbs_);
+    } else {
+        std::vector<uint64_t> scratch(mul_scratch_limbs(n));
+        sqr_limbs(limbs_, n, result.limbs_, scratch.data());
     }
+    result.strip_leading_zeros();
+    return result;
 }
 
 BigInt BigInt::operator*(const BigInt& other) const {
+    if (this == &other) return sqr();
     if (is_zero() || other.is_zero()) return BigInt(int64_t(0));
     size_t n = std::max(size_, other.size_);
-    // FFT для очень больших чисел
-    if (n > FFT_THRESHOLD) {
-        size_t out_limbs = size_ + other.size_ + 2;
-        std::unique_ptr<uint64_t[]> out(new uint64_t[out_limbs]{});
-        fft_mul(limbs_.get(), size_, other.limbs_.get(), other.size_, out.get());
-        BigInt result(out_limbs, false);
-        for (size_t i = 0; i < out_limbs; ++i) result.limbs_[i] = out[i];
-        result.size_ = size_ + other.size_;
+    const size_t m = std::min(size_, other.size_);
+    // NTT для очень больших чисел
+    if (m >= NTT_THRESHOLD) {
+        BigInt result(size_ + other.size_, false);
+        ntt_mul(limbs_, size_, other.limbs_, other.size_, result.limbs_);
         result.is_negative_ = (is_negative_ != other.is_negative_);
         result.strip_leading_zeros();
         return result;
     }
-    size_t n2 = 1;
-    while (n2 < n) n2 <<= 1;
-    if (n2 <= KARATSUBA_THRESHOLD) {
-        BigInt result(size_ + other.size_, true);
-        schoolbook_mul(limbs_.get(), size_, other.limbs_.get(), other.size_, result.limbs_.get());
-        result.size_ = size_ + other.size_;
+    if (m >= TOOM3_THRESHOLD && 2 * m <= n) {
+        // Несбалансированные: куски длинного операнда умножаются на короткий через Тоома/NTT
+        const BigInt& longer = size_ >= other.size_ ? *this : other;
+        const BigInt shorter = (size_ >= other.size_ ? other : *this).abs();
+        BigInt result(n + m, false);
+        std::vector<uint64_t> prod(2 * m);
+        chunked_mul(longer.limbs_, n, m, result.limbs_, prod.data(), [&](const uint64_t* chunk, size_t len, uint64_t* out) {
+            (from_limbs(chunk, len) * shorter).to_limbs(out, len + m);
+        });
         result.is_negative_ = (is_negative_ != other.is_negative_);
         result.strip_leading_zeros();
         return result;
     }
-    // karatsuba: выделяем буферы вручную
-    size_t out_limbs = 2 * n2;
-    std::unique_ptr<uint64_t[]> a2(new uint64_t[n2]{});
-    std::unique_ptr<uint64_t[]> b2(new uint64_t[n2]{});
-    for (size_t i = 0; i < size_; ++i) a2[i] = limbs_[i];
-    for (size_t i = 0; i < other.size_; ++i) b2[i] = other.limbs_[i];
-    std::unique_ptr<uint64_t[]> out(new uint64_t[out_limbs]{});
-    std::unique_ptr<uint64_t[]> buf(new uint64_t[8 * (n2 / 2)]{}); // karatsuba temp
-    karatsuba_mul(a2.get(), n2, b2.get(), n2, out.get(), buf.get());
-    BigInt result(2 * n2, false);
-    for (size_t i = 0; i < 2 * n2; ++i) result.limbs_[i] = out[i];
-    result.size_ = size_ + other.size_;
+    if (m >= TOOM3_THRESHOLD) {
+        BigInt result = m >= TOOM4_THRESHOLD && 4 * m > 3 * n ? toom4_mul(*this, other) : toom3_mul(*this, other);
+        result.is_negative_ = (is_negative_ != other.is_negative_) && !result.is_zero();
+        return result;
+    }
+    BigInt result(size_ + other.size_, false);
+    if (m <= KARATSUBA_THRESHOLD) {
+        schoolbook_mul(limbs_, size_, other.limbs_, other.size_, result.limbs_);
+    } else {
+        std::vector<uint64_t> scratch(mul_scratch_limbs(n));
+        mul_limbs(limbs_, size_, other.limbs_, other.size_, result.limbs_, scratch.data());
+    }
     result.is_negative_ = (is_negative_ != other.is_negative_);
     result.strip_leading_zeros();
     return result;
 }
-BigInt& BigInt::operator*=(const BigInt& other) { *this = *this * other; return *this; }
+BigInt& BigInt::operator*=(const BigInt& other) {
+    if (other.size_ == 1 && this != &other) {
+        is_negative_ = is_negative_ != other.is_negative_;
+        mul_limb_inplace(other.limbs_[0]);
+        return *this;
+    }
+    *this = *this * other;
+    return *this;
+}
 
 BigInt BigInt::operator/(const BigInt& other) const {
     if (other.is_zero()) throw std::runtime_error("Division by zero.");
     if (is_zero()) return BigInt(int64_t(0));
-    auto result_pair = div_mod_magnitude(this->abs(), other.abs());
-    BigInt quotient = result_pair.first;
+    BigInt quotient = div_mod_magnitude(*this, other).first;
     if (!quotient.is_zero() && (is_negative_ != other.is_negative_)) {
         quotient.is_negative_ = true;
     }
     return quotient;
 }
-BigInt& BigInt::operator/=(const BigInt& other) { *this = *this / other; return *this; }
+BigInt& BigInt::operator/=(const BigInt& other) {
+    if (other.size_ == 1 && this != &other) {
+        bool negative = is_negative_ != other.is_negative_;
+        div_limb_inplace(other.limbs_[0]);
+        is_negative_ = negative && !is_zero();
+        return *this;
+    }
+    *this = *this / other;
+    return *this;
+}
+
+uint64_t BigInt::div_limb_inplace(uint64_t d) {
+    uint64_t rem = divmod_limb(limbs_, size_, d, limbs_);
+    strip_leading_zeros();
+    return rem;
+}
+
+uint64_t BigInt::mod_u64(uint64_t d) const {
+    if (d == 0) throw std::runtime_error("Division by zero.");
+    uint64_t rem = 0;
+    for (size_t i = size_; i > 0; --i) div_128_by_64(rem, limbs_[i - 1], d, rem);
+    return rem;
+}
 
 BigInt BigInt::operator%(const BigInt& other) const {
     if (other.is_zero()) throw std::runtime_error("Division by zero.");
     if (is_zero()) return BigInt(int64_t(0));
-    auto result_pair = div_mod_magnitude(this->abs(), other.abs());
-    BigInt remainder = result_pair.second;
+    BigInt remainder = div_mod_magnitude(*this, other).second;
     if (!remainder.is_zero() && is_negative_) {
         remainder.is_negative_ = true;
     }
     return remainder;
 }
-BigInt& BigInt::operator%=(const BigInt& other) { *this = *this % other; return *this; }
+BigInt& BigInt::operator%=(const BigInt& other) {
+    if (other.size_ == 1 && this != &other && !is_zero()) {
+        bool negative = is_negative_;
+        uint64_t rem = div_limb_inplace(other.limbs_[0]);
+        limbs_[0] = rem;
+        size_ = 1;
+        is_negative_ = negative;
+        strip_leading_zeros();
+        return *this;
+    }
+    *this = *this % other;
+    return *this;
+}
 
 BigInt BigInt::operator<<(size_t bits) const { BigInt result = *this; result <<= bits; return result; }
 BigInt& BigInt::operator<<=(size_t bits) {
@@ -574,10 +1182,10 @@ BigInt& BigInt::operator<<=(size_t bits) {
     if (bit_shift > 0 && old_size > 0 && (limbs_[old_size - 1] >> (64 - bit_shift)) > 0) {
         new_size++;
     }
-    if (capacity_ < new_size) resize(new_size);
+    grow(new_size);
 
     if (bit_shift == 0) {
-        std::move_backward(limbs_.get(), limbs_.get() + old_size, limbs_.get() + new_size);
+        std::move_backward(limbs_, limbs_ + old_size, limbs_ + new_size);
     } else {
         if (new_size > old_size + limb_shift) {
              limbs_[new_size - 1] = limbs_[old_size - 1] >> (64 - bit_shift);
@@ -588,7 +1196,7 @@ BigInt& BigInt::operator<<=(size_t bits) {
             limbs_[i - 1 + limb_shift] = (val << bit_shift) | carry;
         }
     }
-    std::fill(limbs_.get(), limbs_.get() + limb_shift, 0);
+    std::fill(limbs_, limbs_ + limb_shift, 0);
     size_ = new_size;
     strip_leading_zeros();
     return *this;
@@ -602,7 +1210,7 @@ BigInt& BigInt::operator>>=(size_t bits) {
     if (limb_shift >= size_) { *this = BigInt(int64_t(0)); return *this; }
     const size_t new_size = size_ - limb_shift;
     if (bit_shift == 0) {
-        std::move(limbs_.get() + limb_shift, limbs_.get() + size_, limbs_.get());
+        std::move(limbs_ + limb_shift, limbs_ + size_, limbs_);
     } else {
         for (size_t i = 0; i < new_size; ++i) {
             uint64_t lower = limbs_[i + limb_shift];
@@ -655,7 +1263,13 @@ BigInt BigInt::operator&(const BigInt& other) const {
     out.is_negative_ = neg && !out.is_zero();
     return out;
 }
-BigInt& BigInt::operator&=(const BigInt& other) { *this = *this & other; return *this; }
+BigInt& BigInt::operator&=(const BigInt& other) {
+    if (is_negative_ || other.is_negative_) { *this = *this & other; return *this; }
+    size_ = std::min(size_, other.size_);
+    for (size_t i = 0; i < size_; ++i) limbs_[i] &= other.limbs_[i];
+    strip_leading_zeros();
+    return *this;
+}
 
 BigInt BigInt::operator|(const BigInt& other) const {
     size_t n = std::max(size_, other.size_);
@@ -697,7 +1311,16 @@ BigInt BigInt::operator|(const BigInt& other) const {
     out.is_negative_ = neg && !out.is_zero();
     return out;
 }
-BigInt& BigInt::operator|=(const BigInt& other) { *this = *this | other; return *this; }
+BigInt& BigInt::operator|=(const BigInt& other) {
+    if (is_negative_ || other.is_negative_) { *this = *this | other; return *this; }
+    if (size_ < other.size_) {
+        grow(other.size_);
+        std::copy(other.limbs_ + size_, other.limbs_ + other.size_, limbs_ + size_);
+    }
+    for (size_t i = 0, n = std::min(size_, other.size_); i < n; ++i) limbs_[i] |= other.limbs_[i];
+    size_ = std::max(size_, other.size_);
+    return *this;
+}
 
 BigInt BigInt::operator^(const BigInt& other) const {
     size_t n = std::max(size_, other.size_);
@@ -739,7 +1362,17 @@ BigInt BigInt::operator^(const BigInt& other) const {
     out.is_negative_ = neg && !out.is_zero();
     return out;
 }
-BigInt& BigInt::operator^=(const BigInt& other) { *this = *this ^ other; return *this; }
+BigInt& BigInt::operator^=(const BigInt& other) {
+    if (is_negative_ || other.is_negative_) { *this = *this ^ other; return *this; }
+    if (size_ < other.size_) {
+        grow(other.size_);
+        std::copy(other.limbs_ + size_, other.limbs_ + other.size_, limbs_ + size_);
+    }
+    for (size_t i = 0, n = std::min(size_, other.size_); i < n; ++i) limbs_[i] ^= other.limbs_[i];
+    size_ = std::max(size_, other.size_);
+    strip_leading_zeros();
+    return *this;
+}
 
 bool BigInt::operator==(const BigInt& other) const {
     if (is_zero() && other.is_zero()) return true;
@@ -766,18 +1399,108 @@ std::string BigInt::to_hex_string() const {
     return (is_negative_ ? "-" : "") + std::string("0x") + ss.str();
 }
 
+namespace {
+
+constexpr uint64_t DEC_CHUNK = 10000000000000000000ULL; // 10^19 — наибольшая степень 10 в limb-е
+constexpr size_t DEC_CHUNK_DIGITS = 19;
+constexpr size_t DEC_DC_THRESHOLD = 48; // limb-ов; меньшие числа преобразуются поблочно
+
+// Поблочный вывод: по одному делению на 10^19 на каждые 19 цифр. u портится.
+// width == 0 — без ведущих нулей, иначе ровно width цифр.
+void append_dec_chunked(uint64_t* u, size_t n, size_t width, std::string& out) {
+    std::string digits; // в обратном порядке
+    while (n > 0 && u[n - 1] == 0) --n;
+    while (n > 0) {
+        uint64_t chunk = divmod_limb(u, n, DEC_CHUNK, u);
+        while (n > 0 && u[n - 1] == 0) --n;
+        for (size_t i = 0; i < DEC_CHUNK_DIGITS; ++i) {
+            digits += char('0' + chunk % 10);
+            chunk /= 10;
+        }
+    }
+    while (!digits.empty() && digits.back() == '0') digits.pop_back();
+    if (width > digits.size()) digits.append(width - digits.size(), '0');
+    out.append(digits.rbegin(), digits.rend());
+}
+
+} // namespace
+
+const BigInt& BigInt::dec_power(size_t k) {
+    thread_local std::vector<BigInt> powers;
+    if (powers.empty()) {
+        BigInt p(1, false);
+        p.limbs_[0] = DEC_CHUNK;
+        powers.push_back(std::move(p));
+    }
+    while (powers.size() <= k) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    return powers[k];
+}
+
+// Инвариант: x < dec_power(k)^2
+void BigInt::to_dec_recursive(const BigInt& x, size_t k, size_t width, std::string& out) {
+    if (x.size_ <= DEC_DC_THRESHOLD) {
+        std::vector<uint64_t> tmp(x.limbs_, x.limbs_ + x.size_);
+        append_dec_chunked(tmp.data(), tmp.size(), width, out);
+        return;
+    }
+    const BigInt& pk = dec_power(k);
+    if (x.compare_magnitude(pk) < 0) {
+        to_dec_recursive(x, k - 1, width, out);
+        return;
+    }
+    auto qr = div_mod_magnitude(x, pk);
+    const size_t low_digits = DEC_CHUNK_DIGITS << k;
+    to_dec_recursive(qr.first, k - 1, width ? width - low_digits : 0, out);
+    to_dec_recursive(qr.second, k - 1, low_digits, out);
+}
+
+BigInt BigInt::from_dec_recursive(const char* digits, size_t len) {
+    if (len <= DEC_DC_THRESHOLD * DEC_CHUNK_DIGITS) {
+        // Поблочный разбор: result = result * 10^c + chunk, до 19 цифр за шаг
+        BigInt result(len / DEC_CHUNK_DIGITS + 1, true);
+        result.size_ = 0;
+        size_t pos = 0;
+        size_t first = len % DEC_CHUNK_DIGITS ? len % DEC_CHUNK_DIGITS : DEC_CHUNK_DIGITS;
+        while (pos < len) {
+            size_t count = pos == 0 ? first : DEC_CHUNK_DIGITS;
+            uint64_t chunk = 0, scale = 1;
+            for (size_t i = 0; i < count; ++i) {
+                chunk = chunk * 10 + dec_char_to_val(digits[pos + i]);
+                scale *= 10;
+            }
+            pos += count;
+            uint64_t carry = chunk;
+            for (size_t i = 0; i < result.size_; ++i) {
+                unsigned __int128 cur = (unsigned __int128)result.limbs_[i] * scale + carry;
+                result.limbs_[i] = (uint64_t)cur;
+                carry = (uint64_t)(cur >> 64);
+            }
+            if (carry) result.limbs_[result.size_++] = carry;
+        }
+        result.strip_leading_zeros();
+        return result;
+    }
+    // len = hi_len + 19*2^k, где 19*2^k — наибольшая такая длина меньше len
+    size_t k = 0;
+    while ((DEC_CHUNK_DIGITS << (k + 1)) < len) ++k;
+    const size_t low_len = DEC_CHUNK_DIGITS << k;
+    BigInt hi = from_dec_recursive(digits, len - low_len);
+    BigInt lo = from_dec_recursive(digits + len - low_len, low_len);
+    return hi * dec_power(k) + lo;
+}
+
 std::string BigInt::to_dec_string() const {
     if (is_zero()) return "0";
     std::string dec_str;
-    BigInt temp = this->abs();
-    BigInt ten(10);
-    while (!temp.is_zero()) {
-        auto pair = div_mod_magnitude(temp, ten);
-        temp = pair.first;
-        dec_str += std::to_string(pair.second.is_zero() ? 0 : pair.second.limbs_[0]);
-    }
     if (is_negative_) dec_str += '-';
-    std::reverse(dec_str.begin(), dec_str.end());
+    // Наименьшее k, при котором dec_power(k)^2 > |this|
+    size_t k = 0;
+    if (size_ > DEC_DC_THRESHOLD) {
+        while (2 * (dec_power(k).bit_length() - 1) < bit_length()) ++k;
+    }
+    to_dec_recursive(*this, k, 0, dec_str);
     return dec_str;
 }
 
@@ -790,6 +1513,24 @@ size_t BigInt::bit_length() const {
     top_limb_bits = 64 - __builtin_clzll(top_limb); // Используем встроенную функцию компилятора для скорости
     return ((size_ - 1) * 64) + top_limb_bits;
 }
+uint64_t BigInt::low_u64() const { return size_ > 0 ? limbs_[0] : 0; }
+BigInt BigInt::from_limbs(const uint64_t* limbs, size_t count) {
+    if (count == 0) return BigInt(int64_t(0));
+    BigInt result(count, false);
+    std::copy(limbs, limbs + count, result.limbs_);
+    result.strip_leading_zeros();
+    return result;
+}
+void BigInt::to_limbs(uint64_t* out, size_t count) const {
+    const size_t n = std::min(size_, count);
+    std::copy(limbs_, limbs_ + n, out);
+    std::fill(out + n, out + count, 0);
+}
+bool BigInt::test_bit(size_t bit) const {
+    size_t limb_idx = bit / 64;
+    if (limb_idx >= size_) return false;
+    return (limbs_[limb_idx] >> (bit % 64)) & 1;
+}
 BigInt BigInt::abs() const {
     BigInt result = *this;
     result.is_negative_ = false;
@@ -0,0 +1,166 @@
+#include "bignum/montgomery.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <immintrin.h>
+
+namespace bignum {
+
+MontgomeryContext::MontgomeryContext(const BigInt& modulus) : modulus_(modulus.abs()) {
+    if (modulus_.size_ == 0 || (modulus_.limbs_[0] & 1) == 0 || modulus_ == BigInt(1)) {
+        throw std::invalid_argument("Montgomery modulus must be odd and greater than 1");
+    }
+    const size_t k = modulus_.size_;
+    n_.assign(modulus_.limbs_, modulus_.limbs_ + k);
+
+    // Обратный к N[0] по модулю 2^64 методом Ньютона: каждая итерация удваивает число верных бит
+    uint64_t inv = 1;
+    for (int i = 0; i < 6; ++i) inv *= 2 - n_[0] * inv;
+    n_prime_ = ~inv + 1;
+
+    auto to_limbs = [k](const BigInt& x, std::vector<uint64_t>& out) {
+        out.assign(k, 0);
+        std::copy(x.limbs_, x.limbs_ + x.size_, out.begin());
+    };
+    to_limbs((BigInt(1) << (64 * k)) % modulus_, one_);
+    to_limbs((BigInt(1) << (128 * k)) % modulus_, r2_);
+}
+
+// CIOS (Coarsely Integrated Operand Scanning): умножение и редукция чередуются по limb-ам b
+void MontgomeryContext::mont_mul(uint64_t* out, const uint64_t* a, const uint64_t* b, uint64_t* t) const {
+    const size_t k = n_.size();
+    const uint64_t* n = n_.data();
+    std::fill(t, t + k + 2, 0);
+    for (size_t i = 0; i < k; ++i) {
+        unsigned __int128 carry = 0;
+        const uint64_t bi = b[i];
+        for (size_t j = 0; j < k; ++j) {
+            unsigned __int128 cur = (unsigned __int128)a[j] * bi + t[j] + carry;
+            t[j] = (uint64_t)cur;
+            carry = cur >> 64;
+        }
+        unsigned __int128 top = (unsigned __int128)t[k] + carry;
+        t[k] = (uint64_t)top;
+        t[k + 1] = (uint64_t)(top >> 64);
+
+        const uint64_t m = t[0] * n_prime_;
+        carry = ((unsigned __int128)m * n[0] + t[0]) >> 64;
+        for (size_t j = 1; j < k; ++j) {
+            unsigned __int128 cur = (unsigned __int128)m * n[j] + t[j] + carry;
+            t[j - 1] = (uint64_t)cur;
+            carry = cur >> 64;
+        }
+        top = (unsigned __int128)t[k] + carry;
+        t[k - 1] = (uint64_t)top;
+        t[k] = t[k + 1] + (uint64_t)(top >> 64);
+    }
+    reduce_once(out, t);
+}
+
+// t[0, k] < 2N -> out = t mod N: не более одного вычитания
+void MontgomeryContext::reduce_once(uint64_t* out, const uint64_t* t) const {
+    const size_t k = n_.size();
+    const uint64_t* n = n_.data();
+    bool ge = t[k] != 0;
+    if (!ge) {
+        ge = true;
+        for (size_t i = k; i > 0; --i) {
+            if (t[i - 1] != n[i - 1]) { ge = t[i - 1] > n[i - 1]; break; }
+        }
+    }
+    if (ge) {
+        unsigned char borrow = 0;
+        for (size_t i = 0; i < k; ++i) {
+            borrow = _subborrow_u64(borrow, t[i], n[i], reinterpret_cast<unsigned long long*>(&out[i]));
+        }
+    } else {
+        std::copy(t, t + k, out);
+    }
+}
+
+// Сначала полный квадрат (попарные произведения один раз, удвоение, диагональ), затем REDC
+void MontgomeryContext::mont_sqr(uint64_t* out, const uint64_t* a, uint64_t* t) const {
+    const size_t k = n_.size();
+    const uint64_t* n = n_.data();
+    std::fill(t, t + 2 * k + 1, 0);
+    for (size_t i = 0; i + 1 < k; ++i) {
+        unsigned __int128 carry = 0;
+        for (size_t j = i + 1; j < k; ++j) {
+            unsigned __int128 cur = (unsigned __int128)a[i] * a[j] + t[i + j] + carry;
+            t[i + j] = (uint64_t)cur;
+            carry = cur >> 64;
+        }
+        t[i + k] = (uint64_t)carry;
+    }
+    uint64_t top = 0;
+    for (size_t i = 0; i < 2 * k; ++i) {
+        const uint64_t v = t[i];
+        t[i] = (v << 1) | top;
+        top = v >> 63;
+    }
+    unsigned char c = 0;
+    for (size_t i = 0; i < k; ++i) {
+        const unsigned __int128 sq = (unsigned __int128)a[i] * a[i];
+        c = _addcarry_u64(c, t[2 * i], (uint64_t)sq, reinterpret_cast<unsigned long long*>(&t[2 * i]));
+        c = _addcarry_u64(c, t[2 * i + 1], (uint64_t)(sq >> 64), reinterpret_cast<unsigned long long*>(&t[2 * i + 1]));
+    }
+
+    // REDC: k раз обнуляем младший limb прибавлением m*N; t[2k] принимает перенос
+    for (size_t i = 0; i < k; ++i) {
+        const uint64_t m = t[i] * n_prime_;
+        unsigned __int128 carry = 0;
+        for (size_t j = 0; j < k; ++j) {
+            unsigned __int128 cur = (unsigned __int128)m * n[j] + t[i + j] + carry;
+            t[i + j] = (uint64_t)cur;
+            carry = cur >> 64;
+        }
+        unsigned char cc = _addcarry_u64(0, t[i + k], (uint64_t)carry, reinterpret_cast<unsigned long long*>(&t[i + k]));
+        for (size_t j = i + k + 1; cc && j <= 2 * k; ++j) {
+            cc = _addcarry_u64(cc, t[j], 0, reinterpret_cast<unsigned long long*>(&t[j]));
+        }
+    }
+    reduce_once(out, t + k);
+}
+
+void MontgomeryContext::to_montgomery(const BigInt& a, uint64_t* out) const {
+    BigInt r = a % modulus_;
+    if (r.is_negative()) r += modulus_;
+    std::vector<uint64_t> tmp(limbs(), 0);
+    std::copy(r.limbs_, r.limbs_ + r.size_, tmp.begin());
+    std::vector<uint64_t> scratch(scratch_limbs());
+    mont_mul(out, tmp.data(), r2_.data(), scratch.data());
+}
+
+BigInt MontgomeryContext::from_montgomery(const uint64_t* a) const {
+    const size_t k = limbs();
+    std::vector<uint64_t> unit(k, 0);
+    unit[0] = 1;
+    std::vector<uint64_t> scratch(scratch_limbs());
+    BigInt result(k, false);
+    mont_mul(result.limbs_, a, unit.data(), scratch.data());
+    result.strip_leading_zeros();
+    return result;
+}
+
+BigInt MontgomeryContext::mul(const BigInt& a, const BigInt& b) const {
+    const size_t k = limbs();
+    std::vector<uint64_t> am(k), bm(k), scratch(scratch_limbs());
+    to_montgomery(a, am.data());
+    to_montgomery(b, bm.data());
+    mont_mul(am.data(), am.data(), bm.data(), scratch.data());
+    return from_montgomery(am.data());
+}
+
+BigInt MontgomeryContext::pow(const BigInt& base, const BigInt& exp) const {
+    if (exp.is_negative()) throw std::invalid_argument("Negative exponent not supported");
+    const size_t k = limbs();
+    std::vector<uint64_t> b(k), acc(one_), scratch(scratch_limbs());
+    to_montgomery(base, b.data());
+    // Бинарное возведение слева направо
+    for (size_t i = exp.bit_length(); i > 0; --i) {
+        mont_sqr(acc.data(), acc.data(), scratch.data());
+        if (exp.test_bit(i - 1)) mont_mul(acc.data(), acc.data(), b.data(), scratch.data());
+    }
+    return from_montgomery(acc.data());
+}
+
+} // namespace bignum
@@ -2,17 +2,107 @@
 #define CRYPTO_LIB_HPP
 
 #include "bignum/bignum.hpp"
+#include "bignum/barrett.hpp"
+#include "bignum/montgomery.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <utility>
+#include <vector>
 
+using bignum::BarrettReducer;
 using bignum::BigInt;
+using bignum::MontgomeryContext;
 
 BigInt multiply_mod(const BigInt& a, const BigInt& b, const BigInt& mod);
 
 BigInt power_mod(const BigInt& a, const BigInt& x, const BigInt& p);
 
+// Произведение bases[i]^exps[i] mod p (метод Штрауса): цепочка возведений в квадрат общая
+// для всех слагаемых, у каждого основания своя таблица нечётных степеней и скользящее окно.
+// Два слагаемых по 2048 бит считаются быстрее, чем один power_mod. exps[i] >= 0, размеры совпадают.
+BigInt multi_power_mod(const std::vector<BigInt>& bases, const std::vector<BigInt>& exps, const BigInt& p);
+
+// Возведение фиксированного основания в степень по нечётному модулю (окна Яо/BGMW).
+// Хранит base^(j * 2^(w*i)) для каждой позиции окна i и цифры j = 1..2^w-1, поэтому
+// pow стоит не более ceil(max_exp_bits / w) умножений без единого возведения в квадрат.
+// Таблица занимает ceil(max_exp_bits / w) * (2^w - 1) чисел размера модуля.
+class FixedBasePowTable {
+public:
+    // modulus нечётный и больше 1 (по модулю), window_bits от 1 до 16; иначе std::invalid_argument
+    FixedBasePowTable(const BigInt& base, const BigInt& modulus, size_t max_exp_bits, unsigned window_bits = 5);
+
+    // base^exp mod modulus, exp >= 0. Показатели длиннее max_exp_bits — обычным возведением.
+    BigInt pow(const BigInt& exp) const;
+
+    const BigInt& modulus() const { return ctx_.modulus(); }
+    size_t max_exp_bits() const { return max_exp_bits_; }
+
+private:
+    MontgomeryContext ctx_;
+    BigInt base_;
+    size_t max_exp_bits_;
+    unsigned window_bits_;
+    size_t windows_;
+    std::vector<uint64_t> table_; // windows_ строк по (2^w - 1) значений в форме Монтгомери
+};
+
 bool is_prime_fermat(const BigInt& n, int iterations = 50);
 
+enum class PrimalityTest {
+    MillerRabin, // Миллер–Рабин со случайными основаниями
+    BailliePSW   // сильный тест по основанию 2 + сильный тест Люка (параметры Селфриджа)
+};
+
+// Пробное деление на малые простые, затем выбранный тест. Для n < 2^64 ответ точный
+// (детерминированный набор оснований 2..37), rounds не используется.
+// Для MillerRabin rounds — число случайных оснований, для BailliePSW — число
+// дополнительных раундов Миллера–Рабина поверх BPSW (может быть 0).
+bool is_probable_prime(const BigInt& n, int rounds = 25, PrimalityTest test = PrimalityTest::MillerRabin);
+
 BigInt extended_euclidean(const BigInt& a, const BigInt& b, BigInt& x, BigInt& y);
 
+// a^{-1} mod m в диапазоне [0, |m|); std::invalid_argument, если gcd(a, m) != 1
+BigInt mod_inverse(const BigInt& a, const BigInt& m);
+// Обращает все элементы на месте приёмом Монтгомери: одно обращение и 3(n-1) умножений.
+// Если хотя бы один элемент необратим — std::invalid_argument, values не меняется.
+void batch_mod_inverse(std::vector<BigInt>& values, const BigInt& m);
+
+// Параметры поиска простых
+struct PrimeSearchOptions {
+    unsigned threads = 1;         // 0 — по числу аппаратных потоков
+    std::optional<uint64_t> seed; // задан — результат воспроизводим и не зависит от threads
+    int rounds = 25;              // раунды Миллера–Рабина
+};
+
+// Случайное простое из [min, max]: случайная точка диапазона и поиск вперёд с просеиванием.
+// Кандидаты одного окна решета проверяются параллельно, первое найденное отменяет остальные.
 BigInt generate_random_prime(const BigInt& min, const BigInt& max);
+BigInt generate_random_prime(const BigInt& min, const BigInt& max, const PrimeSearchOptions& options);
+
+// Равномерно случайное число ровно из bits бит (старший бит установлен), bits >= 1
+BigInt random_bigint(size_t bits, std::mt19937_64& rng);
+// Равномерно случайное число из [0, bound), bound > 0
+BigInt random_below(const BigInt& bound, std::mt19937_64& rng);
+// Случайное вероятно простое ровно из bits бит, bits >= 2
+BigInt generate_prime(size_t bits, std::mt19937_64& rng, int rounds = 25);
+BigInt generate_prime(size_t bits, const PrimeSearchOptions& options);
+// count простых по bits бит; элементы пакета распределяются по потокам
+std::vector<BigInt> generate_primes(size_t count, size_t bits, const PrimeSearchOptions& options = {});
+
+// Безопасное простое p = 2q + 1 (q тоже простое) ровно из bits бит, bits >= 3.
+// q и 2q + 1 просеиваются совместно; простота p следует из простоты q по Поклингтону.
+BigInt generate_safe_prime(size_t bits, const PrimeSearchOptions& options = {});
+
+// Наименьший образующий группы вычетов по модулю безопасного простого p
+BigInt find_generator(const BigInt& p);
+// То же для произвольного нечётного простого p по списку простых делителей p - 1
+BigInt find_generator(const BigInt& p, const std::vector<BigInt>& prime_factors);
+
+// Разложение n > 0 на простые: пары (простое, степень) по возрастанию. Пробное деление
+// на простые до 2^16, затем ро-метод Полларда–Брента; простоту множителей проверяет
+// is_probable_prime. Время растёт как корень из второго по величине простого делителя.
+std::vector<std::pair<BigInt, unsigned>> factorize(const BigInt& n);
 
 #endif // CRYPTO_LIB_HPP
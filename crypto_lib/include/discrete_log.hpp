@@ -1,10 +1,56 @@
 #pragma once
 
 #include "bignum/bignum.hpp"
+#include <cstddef>
 #include <optional>
 
 using bignum::BigInt;
 
+struct DiscreteLogOptions {
+    // Upper bound for the baby-step table, about 10 bytes per baby step. BSGS takes
+    // m = min(ceil(sqrt(order)), memory_budget / 10) baby steps and ceil(order / m) giant steps,
+    // so a smaller budget trades memory for time instead of failing.
+    size_t memory_budget = size_t(1) << 30;
+    // Order of a (or of the group generated by it) when known; p - 1 otherwise.
+    std::optional<BigInt> order;
+    unsigned threads = 1; // 0 = hardware concurrency
+};
+
 // If debug==true the function may print diagnostic information to stdout.
+// Uses the default DiscreteLogOptions; returns std::nullopt (does not throw) when the
+// group order is too large for the default memory budget.
 std::optional<BigInt> discrete_log_bsgs(const BigInt& a, const BigInt& y, const BigInt& p, bool debug = false);
 
+// Smallest x >= 0 with a^x = y (mod p) found within the order, or std::nullopt if there is none.
+// Throws std::invalid_argument if the budget cannot hold a single baby step or the
+// resulting number of giant steps does not fit in 62 bits.
+std::optional<BigInt> discrete_log_bsgs(const BigInt& a, const BigInt& y, const BigInt& p, const DiscreteLogOptions& options);
+
+// Parallel baby-step giant-step on `threads` threads (0 = hardware concurrency).
+// Baby steps are computed in independent strides into one shared open-addressing table
+// that the threads fill with compare-and-swap; giant steps are split into ranges with an
+// early exit once any thread finds a match.
+// Returns the same logarithm as discrete_log_bsgs, std::nullopt for orders it cannot handle.
+std::optional<BigInt> discrete_log_bsgs_parallel(const BigInt& a, const BigInt& y, const BigInt& p, unsigned threads = 0);
+
+
+// Pollard's rho with an r-adding walk and Brent cycle detection: O(sqrt(order)) time and
+// O(1) memory. `order` is the order of a (below 2^126); for a prime order the answer is unique.
+// Returns x in [0, order) with a^x = y (mod p), or std::nullopt if y is not in <a>
+// (y^order != 1, or repeated degenerate collisions). Orders below 2^20 are handed to BSGS.
+std::optional<BigInt> discrete_log_rho(const BigInt& a, const BigInt& y, const BigInt& p, const BigInt& order);
+
+// Parallel rho with distinguished points (van Oorschot-Wiener): `threads` walkers
+// (0 = hardware concurrency) share one walk and a table of distinguished points only,
+// so memory stays small and the expected time drops linearly with the number of threads.
+std::optional<BigInt> discrete_log_rho_parallel(const BigInt& a, const BigInt& y, const BigInt& p, const BigInt& order,
+                                                unsigned threads = 0);
+
+// Pohlig-Hellman: factors the order (options.order, or p - 1) with factorize(), solves the log
+// in each prime-power subgroup digit by digit and recombines with the CRT. Each digit is a log
+// in a subgroup of prime order q: BSGS within options.memory_budget for q < 2^20, rho above
+// (parallel when options.threads != 1). The cost is dominated by sqrt of the largest prime
+// factor of the order, so smooth-order groups are solved in milliseconds.
+// Returns the smallest x >= 0 with a^x = y (mod p), or std::nullopt if there is none.
+std::optional<BigInt> discrete_log_pohlig_hellman(const BigInt& a, const BigInt& y, const BigInt& p,
+                                                  const DiscreteLogOptions& options = {});
@@ -5,49 +5,177 @@
 #include <stdexcept>
 #include <string>
 #include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
 using bignum::BigInt;
 
 static bool bigint_to_u64(const BigInt& a, uint64_t& out) {
+    out = 0;
     if (a.is_negative()) return false;
     if (a.bit_length() > 64) return false;
-    try {
-        std::string s = a.to_dec_string();
-        out = std::stoull(s);
-        return true;
-    } catch (...) {
-        return false;
-    }
+    out = a.low_u64();
+    return true;
 }
 
 BigInt multiply_mod(const BigInt& a, const BigInt& b, const BigInt& mod) {
-    BigInt res(0);
-    BigInt base = a % mod;
-    BigInt exp = b;
-    BigInt two(2);
-    while (!exp.is_zero()) {
-        if ((exp % two) == BigInt(1)) res = (res + base) % mod;
-        base = (base + base) % mod;
-        exp = exp >> 1;
-    }
+    if (mod.is_zero()) throw std::runtime_error("Modulus zero in multiply_mod");
+    BigInt m = mod.abs();
+    BigInt res = (a * b) % m;
+    if (res.is_negative()) res += m;
     return res;
 }
 
 BigInt power_mod(const BigInt& a, const BigInt& x, const BigInt& p) {
     if (p.is_zero()) throw std::runtime_error("Modulus zero in power_mod");
+    if (x.is_negative()) throw std::invalid_argument("Negative exponent in power_mod");
+    BigInt mod = p.abs();
+    if (mod == BigInt(1)) return BigInt(0);
+    if (mod.test_bit(0)) return MontgomeryContext(mod).pow(a, x);
+
+    // Чётный модуль: форма Монтгомери неприменима, бинарное возведение с редукцией Барретта
+    const BarrettReducer br(mod);
+    const BigInt base = br.reduce(a);
     BigInt res(1);
-    BigInt base = a % p;
-    BigInt exp = x;
-    BigInt two(2);
-    while (!exp.is_zero()) {
-        if ((exp % two) == BigInt(1)) res = multiply_mod(res, base, p);
-        base = multiply_mod(base, base, p);
-        exp = exp >> 1;
+    for (size_t i = x.bit_length(); i > 0; --i) {
+        res = br.sqr(res);
+        if (x.test_bit(i - 1)) res = br.mul(res, base);
     }
     return res;
 }
 
+namespace {
+
+// Окно показателя одного слагаемого: нечётная цифра digit, младший бит которой стоит на позиции bit
+struct ExpWindow {
+    size_t bit;
+    size_t term;
+    size_t digit;
+};
+
+} // namespace
+
+BigInt multi_power_mod(const std::vector<BigInt>& bases, const std::vector<BigInt>& exps, const BigInt& p) {
+    if (bases.size() != exps.size()) throw std::invalid_argument("multi_power_mod: bases and exponents differ in size");
+    if (p.is_zero()) throw std::runtime_error("Modulus zero in multi_power_mod");
+    for (const BigInt& e : exps) {
+        if (e.is_negative()) throw std::invalid_argument("Negative exponent in multi_power_mod");
+    }
+    const BigInt mod = p.abs();
+    if (mod == BigInt(1)) return BigInt(0);
+    if (!mod.test_bit(0)) {
+        // Чётный модуль: форма Монтгомери неприменима, по одному возведению на слагаемое
+        BigInt res(1);
+        for (size_t i = 0; i < bases.size(); ++i) res = multiply_mod(res, power_mod(bases[i], exps[i], mod), mod);
+        return res;
+    }
+
+    const MontgomeryContext ctx(mod);
+    const size_t k = ctx.limbs();
+    std::vector<uint64_t> scratch(ctx.scratch_limbs()), g2(k);
+    std::vector<size_t> table_offset(bases.size());
+    std::vector<uint64_t> table;
+    std::vector<ExpWindow> windows;
+    size_t max_bits = 0;
+    for (size_t t = 0; t < bases.size(); ++t) {
+        const BigInt& e = exps[t];
+        const size_t bits = e.bit_length();
+        if (bits == 0) continue;
+        max_bits = std::max(max_bits, bits);
+        // Разбиение показателя на скользящие окна с теми же порогами, что у BigInt::pow
+        size_t largest = 1;
+        bignum::for_each_pow_window(bits, bignum::pow_window_bits(bits), [&e](size_t i) { return e.test_bit(i); },
+                                    [&](size_t low, size_t digit) {
+                                        windows.push_back({low, t, digit});
+                                        largest = std::max(largest, digit);
+                                    });
+
+        // Нечётные степени base^1, base^3, ..., base^largest в форме Монтгомери
+        const size_t count = largest / 2 + 1;
+        table_offset[t] = table.size();
+        table.resize(table.size() + count * k);
+        uint64_t* odd = &table[table_offset[t]];
+        ctx.to_montgomery(bases[t], odd);
+        if (count > 1) {
+            ctx.mont_sqr(g2.data(), odd, scratch.data());
+            for (size_t j = 1; j < count; ++j) ctx.mont_mul(odd + j * k, odd + (j - 1) * k, g2.data(), scratch.data());
+        }
+    }
+    std::stable_sort(windows.begin(), windows.end(), [](const ExpWindow& x, const ExpWindow& y) { return x.bit > y.bit; });
+
+    std::vector<uint64_t> acc(ctx.one(), ctx.one() + k);
+    bool started = false;
+    size_t next = 0;
+    for (size_t i = max_bits; i > 0; --i) {
+        if (started) ctx.mont_sqr(acc.data(), acc.data(), scratch.data());
+        for (; next < windows.size() && windows[next].bit == i - 1; ++next) {
+            const ExpWindow& win = windows[next];
+            const uint64_t* entry = &table[table_offset[win.term] + (win.digit / 2) * k];
+            if (started) {
+                ctx.mont_mul(acc.data(), acc.data(), entry, scratch.data());
+            } else {
+                std::copy(entry, entry + k, acc.begin());
+                started = true;
+            }
+        }
+    }
+    return ctx.from_montgomery(acc.data());
+}
+
+namespace {
+
+unsigned checked_window_bits(unsigned window_bits) {
+    if (window_bits == 0 || window_bits > 16) throw std::invalid_argument("FixedBasePowTable: window_bits must be in [1, 16]");
+    return window_bits;
+}
+
+} // namespace
+
+FixedBasePowTable::FixedBasePowTable(const BigInt& base, const BigInt& modulus, size_t max_exp_bits, unsigned window_bits)
+    : ctx_(modulus), base_(base), max_exp_bits_(max_exp_bits), window_bits_(checked_window_bits(window_bits)),
+      windows_((max_exp_bits + window_bits_ - 1) / window_bits_) {
+    const size_t k = ctx_.limbs();
+    const size_t digits = (size_t(1) << window_bits_) - 1;
+    table_.resize(windows_ * digits * k);
+    std::vector<uint64_t> g(k), scratch(ctx_.scratch_limbs());
+    ctx_.to_montgomery(base, g.data());
+    for (size_t i = 0; i < windows_; ++i) {
+        // Строка i: g^1..g^(2^w - 1) при g = base^(2^(w*i)); следующее g = g^(2^w) = g^(2^w - 1) * g
+        uint64_t* row = &table_[i * digits * k];
+        std::copy(g.begin(), g.end(), row);
+        for (size_t j = 1; j < digits; ++j) ctx_.mont_mul(row + j * k, row + (j - 1) * k, g.data(), scratch.data());
+        ctx_.mont_mul(g.data(), row + (digits - 1) * k, g.data(), scratch.data());
+    }
+}
+
+BigInt FixedBasePowTable::pow(const BigInt& exp) const {
+    if (exp.is_negative()) throw std::invalid_argument("Negative exponent in FixedBasePowTable::pow");
+    if (exp.bit_length() > max_exp_bits_) return ctx_.pow(base_, exp);
+    const size_t k = ctx_.limbs();
+    const size_t digits = (size_t(1) << window_bits_) - 1;
+    std::vector<uint64_t> acc(ctx_.one(), ctx_.one() + k), scratch(ctx_.scratch_limbs());
+    bool first = true;
+    for (size_t i = 0; i < windows_; ++i) {
+        size_t d = 0;
+        for (unsigned b = 0; b < window_bits_; ++b) d |= size_t(exp.test_bit(i * window_bits_ + b)) << b;
+        if (d == 0) continue;
+        const uint64_t* entry = &table_[(i * digits + d - 1) * k];
+        if (first) {
+            std::copy(entry, entry + k, acc.begin());
+            first = false;
+        } else {
+            ctx_.mont_mul(acc.data(), acc.data(), entry, scratch.data());
+        }
+    }
+    return ctx_.from_montgomery(acc.data());
+}
+
 bool is_prime_fermat(const BigInt& n, int iterations) {
-    if (n.is_negative() || n.is_zero()) return false;
+    if (n.is_negative() || n.is_zero() || n == BigInt(1)) return false;
     if (n == BigInt(2) || n == BigInt(3)) return true;
     if ((n % BigInt(2)) == BigInt(0)) return false;
 
@@ -55,6 +183,8 @@ bool is_prime_fermat(const BigInt& n, int iterations) {
     bool use_u64 = bigint_to_u64(n, n_u64);
 
     std::mt19937_64 rng(std::chrono::steady_clock::now().time_since_epoch().count());
+    MontgomeryContext ctx(n);
+    const BigInt n_minus_1 = n - BigInt(1);
 
     for (int i = 0; i < iterations; ++i) {
         BigInt a;
@@ -66,44 +196,925 @@ bool is_prime_fermat(const BigInt& n, int iterations) {
 
             a = BigInt(2 + (i % 10));
         }
-        BigInt res = power_mod(a, n - BigInt(1), n);
+        BigInt res = ctx.pow(a, n_minus_1);
         if (!(res == BigInt(1))) return false;
     }
     return true;
 }
 
+namespace {
+
+// Малые простые до SIEVE_PRIME_LIMIT: префикс до TRIAL_DIVISION_LIMIT идёт
+// на пробное деление, вся таблица — на просеивание кандидатов при генерации простых.
+// Простые собраны в группы с произведением < 2^64: на группу приходится один проход
+// mod_u64 по длинному числу, дальше — деление в uint64_t.
+constexpr uint32_t TRIAL_DIVISION_LIMIT = 2048;
+constexpr uint32_t SIEVE_PRIME_LIMIT = 1 << 16;
+constexpr size_t SIEVE_WINDOW = 4096; // нечётных кандидатов в одном окне решета
+
+struct SmallPrimeGroup {
+    uint64_t product;
+    size_t begin, end; // полуинтервал индексов в small_primes()
+};
+
+const std::vector<uint32_t>& small_primes() {
+    static const std::vector<uint32_t> primes = [] {
+        std::vector<bool> composite(SIEVE_PRIME_LIMIT, false);
+        std::vector<uint32_t> result;
+        for (uint32_t i = 2; i < SIEVE_PRIME_LIMIT; ++i) {
+            if (composite[i]) continue;
+            result.push_back(i);
+            for (uint32_t j = i * i; j < SIEVE_PRIME_LIMIT; j += i) composite[j] = true;
+        }
+        return result;
+    }();
+    return primes;
+}
+
+// Группы не пересекают границу TRIAL_DIVISION_LIMIT, чтобы пробное деление шло по префиксу групп
+const std::vector<SmallPrimeGroup>& small_prime_groups() {
+    static const std::vector<SmallPrimeGroup> groups = [] {
+        const std::vector<uint32_t>& primes = small_primes();
+        std::vector<SmallPrimeGroup> result;
+        for (size_t i = 0; i < primes.size();) {
+            SmallPrimeGroup g{1, i, i};
+            const bool trial = primes[i] < TRIAL_DIVISION_LIMIT;
+            while (g.end < primes.size() && (primes[g.end] < TRIAL_DIVISION_LIMIT) == trial &&
+                   g.product <= UINT64_MAX / primes[g.end]) {
+                g.product *= primes[g.end++];
+            }
+            result.push_back(g);
+            i = g.end;
+        }
+        return result;
+    }();
+    return groups;
+}
+
+// 1 — n простое (малое), -1 — n составное, 0 — малых делителей нет, нужен тест
+int trial_division(const BigInt& n) {
+    const std::vector<uint32_t>& primes = small_primes();
+    uint64_t n_u64 = 0;
+    const bool small = bigint_to_u64(n, n_u64);
+    for (const SmallPrimeGroup& g : small_prime_groups()) {
+        if (primes[g.begin] >= TRIAL_DIVISION_LIMIT) break;
+        const uint64_t r = n.mod_u64(g.product);
+        for (size_t i = g.begin; i < g.end; ++i) {
+            if (r % primes[i] == 0) return (small && n_u64 == primes[i]) ? 1 : -1;
+        }
+    }
+    if (small && n_u64 < (uint64_t)TRIAL_DIVISION_LIMIT * TRIAL_DIVISION_LIMIT) return 1;
+    return 0;
+}
+
+uint64_t mul_mod_u64(uint64_t a, uint64_t b, uint64_t m) {
+    return (uint64_t)((unsigned __int128)a * b % m);
+}
+
+uint64_t pow_mod_u64(uint64_t a, uint64_t e, uint64_t m) {
+    uint64_t result = 1;
+    for (a %= m; e; e >>= 1) {
+        if (e & 1) result = mul_mod_u64(result, a, m);
+        a = mul_mod_u64(a, a, m);
+    }
+    return result;
+}
+
+// Сильный тест по основанию a для нечётного n > 2
+bool miller_rabin_u64(uint64_t n, uint64_t a) {
+    a %= n;
+    if (a == 0) return true;
+    uint64_t d = n - 1;
+    const int s = __builtin_ctzll(d);
+    d >>= s;
+    uint64_t x = pow_mod_u64(a, d, n);
+    if (x == 1 || x == n - 1) return true;
+    for (int r = 1; r < s; ++r) {
+        x = mul_mod_u64(x, x, n);
+        if (x == n - 1) return true;
+    }
+    return false;
+}
+
+// Основания 2..37 дают точный ответ для всех n < 2^64
+bool is_prime_u64(uint64_t n) {
+    for (uint64_t a : {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37}) {
+        if (!miller_rabin_u64(n, a)) return false;
+    }
+    return true;
+}
+
+// Сильный тест по основанию a: n - 1 = d * 2^s, d нечётно; minus_one — (n - 1) в форме Монтгомери
+bool miller_rabin_round(const MontgomeryContext& ctx, const BigInt& a, const BigInt& d, size_t s,
+                        const std::vector<uint64_t>& minus_one) {
+    const size_t k = ctx.limbs();
+    std::vector<uint64_t> x(k), scratch(ctx.scratch_limbs());
+    ctx.to_montgomery(ctx.pow(a, d), x.data());
+    auto equals = [k](const uint64_t* u, const uint64_t* v) { return std::equal(u, u + k, v); };
+    if (equals(x.data(), ctx.one()) || equals(x.data(), minus_one.data())) return true;
+    for (size_t r = 1; r < s; ++r) {
+        ctx.mont_sqr(x.data(), x.data(), scratch.data());
+        if (equals(x.data(), minus_one.data())) return true;
+        if (equals(x.data(), ctx.one())) return false;
+    }
+    return false;
+}
+
+// Символ Якоби (a/m) для нечётного m > 0
+int jacobi_u64(uint64_t a, uint64_t m) {
+    int result = 1;
+    a %= m;
+    while (a != 0) {
+        while ((a & 1) == 0) {
+            a >>= 1;
+            if ((m & 7) == 3 || (m & 7) == 5) result = -result;
+        }
+        std::swap(a, m);
+        if ((a & 3) == 3 && (m & 3) == 3) result = -result;
+        a %= m;
+    }
+    return m == 1 ? result : 0;
+}
+
+// (d/n) для малого нечётного d и нечётного n > 0 через квадратичный закон взаимности
+int jacobi_small(int64_t d, const BigInt& n) {
+    const uint64_t n8 = n.low_u64() & 7;
+    const uint64_t a = d < 0 ? (uint64_t)(-d) : (uint64_t)d;
+    int result = (d < 0 && (n8 & 3) == 3) ? -1 : 1;
+    if (a == 1) return result;
+    if ((a & 3) == 3 && (n8 & 3) == 3) result = -result;
+    return result * jacobi_u64(n.mod_u64(a), a);
+}
+
+// floor(sqrt(n)) методом Ньютона
+BigInt isqrt(const BigInt& n) {
+    if (n.is_zero()) return n;
+    BigInt x = BigInt(1) << ((n.bit_length() + 1) / 2);
+    while (true) {
+        BigInt y = (x + n / x) >> 1;
+        if (y >= x) return x;
+        x = std::move(y);
+    }
+}
+
+// Сильный тест Люка с параметрами Селфриджа: D — первое из 5, -7, 9, -11, ... с (D/n) = -1,
+// P = 1, Q = (1 - D)/4. n + 1 = d * 2^s; n проходит, если U_d = 0 или V_{d*2^r} = 0 для r < s.
+bool strong_lucas_selfridge(const BigInt& n) {
+    const BigInt root = isqrt(n);
+    if (root * root == n) return false; // для квадратов подходящего D нет
+    int64_t D = 5;
+    while (true) {
+        const int j = jacobi_small(D, n);
+        if (j == -1) break;
+        if (j == 0) return false; // общий делитель с |D| (n больше любого малого простого)
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+    const BigInt Q((1 - D) / 4);
+
+    BigInt d = n + BigInt(1);
+    size_t s = 0;
+    while (!d.test_bit(s)) ++s;
+    d >>= s;
+
+    auto mod = [&n](BigInt x) {
+        x %= n;
+        if (x.is_negative()) x += n;
+        return x;
+    };
+    // x / 2 mod n для x из [0, n)
+    auto half = [&n](BigInt x) {
+        if (x.test_bit(0)) x += n;
+        x >>= 1;
+        return x;
+    };
+    const BigInt Dm = mod(BigInt(D));
+    const BigInt Qm = mod(Q);
+    BigInt U(1), V(1), Qk = Qm; // индекс 1: U_1 = 1, V_1 = P = 1
+    for (size_t i = d.bit_length() - 1; i > 0; --i) {
+        // Удвоение индекса: U_2k = U_k V_k, V_2k = V_k^2 - 2Q^k
+        U = mod(U * V);
+        V = mod(V.sqr() - (Qk << 1));
+        Qk = mod(Qk.sqr());
+        if (d.test_bit(i - 1)) {
+            // k -> k + 1 при P = 1: U_{k+1} = (U_k + V_k)/2, V_{k+1} = (D U_k + V_k)/2
+            BigInt u_next = half(mod(U + V));
+            V = half(mod(Dm * U + V));
+            U = std::move(u_next);
+            Qk = mod(Qk * Qm);
+        }
+    }
+    if (U.is_zero() || V.is_zero()) return true;
+    for (size_t r = 1; r < s; ++r) {
+        V = mod(V.sqr() - (Qk << 1));
+        if (V.is_zero()) return true;
+        Qk = mod(Qk.sqr());
+    }
+    return false;
+}
+
+} // namespace
+
+namespace {
+
+// Тест без пробного деления: n > 1 нечётно и не имеет малых делителей.
+// Основания Миллера–Рабина берутся из генератора с зерном seed.
+bool passes_primality_test(const BigInt& n, int rounds, PrimalityTest test, uint64_t seed) {
+    uint64_t n_u64;
+    if (bigint_to_u64(n, n_u64)) return is_prime_u64(n_u64);
+
+    MontgomeryContext ctx(n);
+    const BigInt n_minus_1 = n - BigInt(1);
+    size_t s = 0;
+    while (!n_minus_1.test_bit(s)) ++s;
+    const BigInt d = n_minus_1 >> s;
+    std::vector<uint64_t> minus_one(ctx.limbs());
+    ctx.to_montgomery(n_minus_1, minus_one.data());
+
+    if (test == PrimalityTest::BailliePSW) {
+        if (!miller_rabin_round(ctx, BigInt(2), d, s, minus_one)) return false;
+        if (!strong_lucas_selfridge(n)) return false;
+    }
+    std::mt19937_64 rng(seed);
+    for (int i = 0; i < rounds; ++i) {
+        const BigInt a = random_below(n - BigInt(3), rng) + BigInt(2); // [2, n - 2]
+        if (!miller_rabin_round(ctx, a, d, s, minus_one)) return false;
+    }
+    return true;
+}
+
+unsigned resolve_threads(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return std::max(threads, 1u);
+}
+
+uint64_t seed_from_clock() {
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+// SplitMix64: независимые зёрна для элементов пакета из одного базового зерна
+uint64_t derive_seed(uint64_t seed, uint64_t index) {
+    uint64_t z = seed + (index + 1) * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Пул потоков поиска: рабочие живут всё время поиска и разбирают кандидатов каждого
+// окна решета, поэтому потоки не создаются и не присоединяются заново на каждое окно.
+class MatchPool {
+public:
+    explicit MatchPool(unsigned threads) {
+        for (unsigned t = 1; t < threads; ++t) workers_.emplace_back([this] { worker_loop(); });
+    }
+    ~MatchPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& t : workers_) t.join();
+    }
+    MatchPool(const MatchPool&) = delete;
+    MatchPool& operator=(const MatchPool&) = delete;
+
+    // Индекс первого i из [0, count), для которого matches(i), или count.
+    // Потоки разбирают индексы по очереди; найденный индекс отменяет проверку всех
+    // индексов дальше него, а более ранние дорабатываются — ответ совпадает с последовательным.
+    size_t first_match(size_t count, const std::function<bool(size_t)>& matches) {
+        if (workers_.empty() || count <= 1) {
+            for (size_t i = 0; i < count; ++i) {
+                if (matches(i)) return i;
+            }
+            return count;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            matches_ = &matches;
+            next_ = 0;
+            best_ = count;
+            busy_ = workers_.size();
+            ++generation_;
+        }
+        wake_.notify_all();
+        scan();
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+        return best_.load();
+    }
+
+private:
+    void scan() {
+        for (size_t i = next_++; i < best_.load(); i = next_++) {
+            if (!(*matches_)(i)) continue;
+            size_t current = best_.load();
+            while (i < current && !best_.compare_exchange_weak(current, i)) {}
+        }
+    }
+
+    // Каждое окно обрабатывается всеми рабочими ровно один раз: следующее не начнётся, пока busy_ > 0
+    void worker_loop() {
+        uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            scan();
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) done_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function<bool(size_t)>* matches_{nullptr};
+    std::atomic<size_t> next_{0}, best_{0};
+    size_t busy_{0};
+    uint64_t generation_{0};
+    bool stop_{false};
+};
+
+// Смещения j из [0, window), при которых нечётное from + 2j не делится ни на одно малое простое.
+// При safe дополнительно требуется, чтобы не делилось и 2(from + 2j) + 1 (совместное решето q и 2q + 1).
+// Остатки from считаются один раз на окно, далее кратные вычёркиваются без длинной арифметики.
+std::vector<uint32_t> sieve_window(const BigInt& from, size_t window, bool safe) {
+    const std::vector<uint32_t>& primes = small_primes();
+    std::vector<uint8_t> composite(window, 0);
+    for (const SmallPrimeGroup& g : small_prime_groups()) {
+        const uint64_t r_group = from.mod_u64(g.product);
+        for (size_t i = std::max<size_t>(g.begin, 1); i < g.end; ++i) { // 2 пропускается: кандидаты нечётны
+            const uint64_t p = primes[i];
+            const uint64_t r = r_group % p;
+            const uint64_t inv2 = (p + 1) / 2;
+            // from + 2j = 0 (mod p)  =>  j = -r * 2^{-1} mod p
+            for (uint64_t j = (p - r) % p * inv2 % p; j < window; j += p) composite[j] = 1;
+            if (safe) {
+                // 2(from + 2j) + 1 = 0 (mod p)  =>  from + 2j = (p - 1)/2 (mod p)
+                for (uint64_t j = ((p - 1) / 2 + p - r) % p * inv2 % p; j < window; j += p) composite[j] = 1;
+            }
+        }
+    }
+    std::vector<uint32_t> offsets;
+    for (size_t j = 0; j < window; ++j) {
+        if (!composite[j]) offsets.push_back((uint32_t)j);
+    }
+    return offsets;
+}
+
+// Сколько кандидатов from + 2j (j < SIEVE_WINDOW) не превышают to; from <= to
+size_t window_size(const BigInt& from, const BigInt& to) {
+    const BigInt span = to - from;
+    if (span.bit_length() >= 32) return SIEVE_WINDOW;
+    return std::min<size_t>(SIEVE_WINDOW, span.low_u64() / 2 + 1);
+}
+
+// Первое вероятно простое в [from, to] или 0, если его нет. Кандидаты просеиваются окнами по
+// SIEVE_WINDOW нечётных чисел, проверка выживших распределяется по потокам пула. Основания
+// кандидата с номером j выводятся из seed и j, поэтому ответ не зависит от числа потоков.
+BigInt next_prime_in_range(BigInt from, const BigInt& to, int rounds, PrimalityTest test, uint64_t seed, MatchPool& pool) {
+    if (from < BigInt(2)) from = BigInt(2);
+    // Малые значения (сами могут совпадать с простыми из таблицы) перебираются напрямую
+    for (; from <= to && from < BigInt(SIEVE_PRIME_LIMIT); from += BigInt(1)) {
+        if (is_probable_prime(from, rounds, test)) return from;
+    }
+    if (!from.test_bit(0)) from += BigInt(1);
+
+    for (uint64_t base = 0; from <= to; base += SIEVE_WINDOW) {
+        const std::vector<uint32_t> offsets = sieve_window(from, window_size(from, to), false);
+        auto is_prime_at = [&](size_t i) {
+            return passes_primality_test(from + BigInt(int64_t(2) * offsets[i]), rounds, test, derive_seed(seed, base + offsets[i]));
+        };
+        const size_t found = pool.first_match(offsets.size(), is_prime_at);
+        if (found < offsets.size()) return from + BigInt(int64_t(2) * offsets[found]);
+        from += BigInt(int64_t(2 * SIEVE_WINDOW));
+    }
+    return BigInt(0);
+}
+
+// q из [from, to] — первое, для которого q и p = 2q + 1 простые; возвращает p или 0.
+// Для выживших после совместного решета сначала проверяется 2^(p-1) = 1 (mod p): это отсекает
+// почти всех кандидатов одним возведением в степень. Если затем q простое, p простое
+// по критерию Поклингтона (p - 1 = 2q, q > sqrt(p), НОД(2^2 - 1, p) = 1).
+BigInt next_safe_prime_in_range(BigInt from, const BigInt& to, int rounds, uint64_t seed, MatchPool& pool) {
+    auto is_safe = [rounds, seed](const BigInt& q, uint64_t index) {
+        const BigInt p = (q << 1) + BigInt(1);
+        if (!(MontgomeryContext(p).pow(BigInt(2), p - BigInt(1)) == BigInt(1))) return false;
+        return passes_primality_test(q, rounds, PrimalityTest::MillerRabin, derive_seed(seed, index));
+    };
+    if (from < BigInt(2)) from = BigInt(2);
+    for (; from <= to && from < BigInt(SIEVE_PRIME_LIMIT); from += BigInt(1)) {
+        if (is_probable_prime(from, rounds) && is_probable_prime((from << 1) + BigInt(1), rounds)) {
+            return (from << 1) + BigInt(1);
+        }
+    }
+    if (!from.test_bit(0)) from += BigInt(1);
+
+    for (uint64_t base = 0; from <= to; base += SIEVE_WINDOW) {
+        const std::vector<uint32_t> offsets = sieve_window(from, window_size(from, to), true);
+        auto is_safe_at = [&](size_t i) { return is_safe(from + BigInt(int64_t(2) * offsets[i]), base + offsets[i]); };
+        const size_t found = pool.first_match(offsets.size(), is_safe_at);
+        if (found < offsets.size()) return ((from + BigInt(int64_t(2) * offsets[found])) << 1) + BigInt(1);
+        from += BigInt(int64_t(2 * SIEVE_WINDOW));
+    }
+    return BigInt(0);
+}
+
+} // namespace
+
+bool is_probable_prime(const BigInt& n, int rounds, PrimalityTest test) {
+    if (n.is_negative() || n < BigInt(2)) return false;
+    const int by_trial = trial_division(n);
+    if (by_trial != 0) return by_trial > 0;
+    return passes_primality_test(n, rounds, test, seed_from_clock());
+}
+
+BigInt random_bigint(size_t bits, std::mt19937_64& rng) {
+    if (bits == 0) throw std::invalid_argument("random_bigint: bit length must be positive");
+    std::vector<uint64_t> limbs((bits + 63) / 64);
+    for (uint64_t& limb : limbs) limb = rng();
+    const size_t top_bits = bits - 64 * (limbs.size() - 1);
+    if (top_bits < 64) limbs.back() &= (uint64_t(1) << top_bits) - 1;
+    limbs.back() |= uint64_t(1) << (top_bits - 1);
+    return BigInt::from_limbs(limbs.data(), limbs.size());
+}
+
+BigInt random_below(const BigInt& bound, std::mt19937_64& rng) {
+    if (bound.is_negative() || bound.is_zero()) throw std::invalid_argument("random_below: bound must be positive");
+    // Отбраковка: случайные bit_length(bound) бит, принимается с вероятностью > 1/2
+    const size_t bits = bound.bit_length();
+    std::vector<uint64_t> limbs((bits + 63) / 64);
+    const size_t top_bits = bits - 64 * (limbs.size() - 1);
+    while (true) {
+        for (uint64_t& limb : limbs) limb = rng();
+        if (top_bits < 64) limbs.back() &= (uint64_t(1) << top_bits) - 1;
+        BigInt x = BigInt::from_limbs(limbs.data(), limbs.size());
+        if (x < bound) return x;
+    }
+}
+
+namespace {
+
+BigInt search_prime(size_t bits, std::mt19937_64& rng, int rounds, unsigned threads) {
+    if (bits < 2) throw std::invalid_argument("generate_prime: bit length must be at least 2");
+    const BigInt top = (BigInt(1) << bits) - BigInt(1);
+    MatchPool pool(threads);
+    while (true) {
+        // У самой верхней границы простого может не найтись — тогда новая случайная точка
+        const BigInt from = random_bigint(bits, rng);
+        const uint64_t seed = rng();
+        BigInt p = next_prime_in_range(from, top, rounds, PrimalityTest::MillerRabin, seed, pool);
+        if (!p.is_zero()) return p;
+    }
+}
+
+} // namespace
+
+BigInt generate_prime(size_t bits, std::mt19937_64& rng, int rounds) {
+    return search_prime(bits, rng, rounds, 1);
+}
+
+BigInt generate_prime(size_t bits, const PrimeSearchOptions& options) {
+    std::mt19937_64 rng(options.seed ? *options.seed : seed_from_clock());
+    return search_prime(bits, rng, options.rounds, resolve_threads(options.threads));
+}
+
+std::vector<BigInt> generate_primes(size_t count, size_t bits, const PrimeSearchOptions& options) {
+    if (bits < 2) throw std::invalid_argument("generate_prime: bit length must be at least 2");
+    // Каждый элемент ищется своим потоком со своим зерном, поэтому результат
+    // при заданном seed не зависит ни от числа потоков, ни от порядка их работы
+    const uint64_t seed = options.seed ? *options.seed : seed_from_clock();
+    std::vector<BigInt> primes(count);
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t k = next++; k < count; k = next++) {
+            std::mt19937_64 rng(derive_seed(seed, k));
+            primes[k] = search_prime(bits, rng, options.rounds, 1);
+        }
+    };
+    const unsigned threads = std::min<size_t>(resolve_threads(options.threads), std::max<size_t>(count, 1));
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+    return primes;
+}
+
+BigInt generate_safe_prime(size_t bits, const PrimeSearchOptions& options) {
+    if (bits < 3) throw std::invalid_argument("generate_safe_prime: bit length must be at least 3");
+    std::mt19937_64 rng(options.seed ? *options.seed : seed_from_clock());
+    const unsigned threads = resolve_threads(options.threads);
+    // q ровно из bits - 1 бит, тогда p = 2q + 1 ровно из bits бит
+    const BigInt q_top = (BigInt(1) << (bits - 1)) - BigInt(1);
+    MatchPool pool(threads);
+    while (true) {
+        const BigInt from = random_bigint(bits - 1, rng);
+        const uint64_t seed = rng();
+        BigInt p = next_safe_prime_in_range(from, q_top, options.rounds, seed, pool);
+        if (!p.is_zero()) return p;
+    }
+}
+
+BigInt find_generator(const BigInt& p) {
+    if (p < BigInt(5) || !p.test_bit(0)) throw std::invalid_argument("find_generator: p must be a safe prime");
+    const BigInt q = (p - BigInt(1)) >> 1;
+    if (!is_probable_prime(q)) {
+        throw std::invalid_argument("find_generator: p must be a safe prime; pass the factors of p - 1 otherwise");
+    }
+    return find_generator(p, {BigInt(2), q});
+}
+
+BigInt find_generator(const BigInt& p, const std::vector<BigInt>& prime_factors) {
+    if (p < BigInt(3) || !p.test_bit(0)) throw std::invalid_argument("find_generator: p must be an odd prime");
+    // g — образующий, если g^((p-1)/f) != 1 для каждого простого делителя f числа p - 1
+    MontgomeryContext ctx(p);
+    const BigInt order = p - BigInt(1);
+    std::vector<BigInt> exponents;
+    for (const BigInt& f : prime_factors) exponents.push_back(order / f);
+    for (BigInt g(2); g < p; g += BigInt(1)) {
+        bool generator = true;
+        for (const BigInt& e : exponents) {
+            if (ctx.pow(g, e) == BigInt(1)) {
+                generator = false;
+                break;
+            }
+        }
+        if (generator) return g;
+    }
+    throw std::runtime_error("find_generator: no generator found, is p prime?");
+}
+
+namespace {
+
+// out = (a + b) mod n на limb-ах, a, b < n; out может совпадать с a или b
+void add_mod_limbs(uint64_t* out, const uint64_t* a, const uint64_t* b, const uint64_t* n, size_t k) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < k; ++i) {
+        const unsigned __int128 t = (unsigned __int128)a[i] + b[i] + carry;
+        out[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    if (!carry) {
+        size_t i = k;
+        while (i > 0 && out[i - 1] == n[i - 1]) --i;
+        if (i > 0 && out[i - 1] < n[i - 1]) return;
+    }
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < k; ++i) {
+        const unsigned __int128 t = (unsigned __int128)out[i] - n[i] - borrow;
+        out[i] = (uint64_t)t;
+        borrow = (uint64_t)(t >> 64) & 1;
+    }
+}
+
+// out = (a - b) mod n на limb-ах, a, b < n
+void sub_mod_limbs(uint64_t* out, const uint64_t* a, const uint64_t* b, const uint64_t* n, size_t k) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < k; ++i) {
+        const unsigned __int128 t = (unsigned __int128)a[i] - b[i] - borrow;
+        out[i] = (uint64_t)t;
+        borrow = (uint64_t)(t >> 64) & 1;
+    }
+    if (!borrow) return;
+    uint64_t carry = 0;
+    for (size_t i = 0; i < k; ++i) {
+        const unsigned __int128 t = (unsigned __int128)out[i] + n[i] + carry;
+        out[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+}
+
+// Делитель нечётного составного n ро-методом Полларда в варианте Брента, f(x) = x^2 + c.
+// Вся итерация идёт в форме Монтгомери: x*R -> (x^2 + c)*R, а множитель R не меняет НОД с n.
+// Разности копятся в произведение, и один НОД считается на RHO_BATCH шагов. Может вернуть n —
+// тогда нужен другой c.
+constexpr uint64_t RHO_BATCH = 128;
+
+BigInt pollard_brent(const BigInt& n, uint64_t c) {
+    const MontgomeryContext ctx(n);
+    const size_t k = ctx.limbs();
+    std::vector<uint64_t> mod(k), cm(k), x(k), y(k), ys(k), diff(k), scratch(ctx.scratch_limbs());
+    std::vector<uint64_t> q(ctx.one(), ctx.one() + k);
+    n.to_limbs(mod.data(), k);
+    ctx.to_montgomery(BigInt((int64_t)c), cm.data());
+    ctx.to_montgomery(BigInt(2), y.data());
+    auto step = [&](std::vector<uint64_t>& v) {
+        ctx.mont_sqr(v.data(), v.data(), scratch.data());
+        add_mod_limbs(v.data(), v.data(), cm.data(), mod.data(), k);
+    };
+    auto gcd_with_n = [&](const std::vector<uint64_t>& v) {
+        BigInt s, t;
+        return extended_euclidean(BigInt::from_limbs(v.data(), k), n, s, t);
+    };
+
+    const BigInt one(1);
+    BigInt g = one;
+    for (uint64_t r = 1; g == one; r <<= 1) {
+        x = y;
+        for (uint64_t i = 0; i < r; ++i) step(y);
+        for (uint64_t done = 0; done < r && g == one; done += RHO_BATCH) {
+            ys = y;
+            const uint64_t batch = std::min(RHO_BATCH, r - done);
+            for (uint64_t i = 0; i < batch; ++i) {
+                step(y);
+                sub_mod_limbs(diff.data(), x.data(), y.data(), mod.data(), k);
+                ctx.mont_mul(q.data(), q.data(), diff.data(), scratch.data());
+            }
+            g = gcd_with_n(q);
+        }
+    }
+    if (g == n) {
+        // Пакет проскочил делитель: повторяем его по одному шагу
+        do {
+            step(ys);
+            sub_mod_limbs(diff.data(), x.data(), ys.data(), mod.data(), k);
+            g = gcd_with_n(diff);
+        } while (g == one);
+    }
+    return g;
+}
+
+} // namespace
+
+std::vector<std::pair<BigInt, unsigned>> factorize(const BigInt& n_in) {
+    if (n_in <= BigInt(0)) throw std::invalid_argument("factorize: n must be positive");
+    std::vector<BigInt> primes_found;
+    BigInt n = n_in;
+
+    // Пробное деление на все простые из решета: один mod_u64 по длинному числу на группу
+    const std::vector<uint32_t>& primes = small_primes();
+    for (const SmallPrimeGroup& g : small_prime_groups()) {
+        const uint64_t limit = primes[g.begin];
+        if (n < BigInt((int64_t)(limit * limit))) break;
+        const uint64_t r = n.mod_u64(g.product);
+        for (size_t i = g.begin; i < g.end; ++i) {
+            if (r % primes[i] != 0) continue;
+            const BigInt f((int64_t)primes[i]);
+            do {
+                n /= f;
+                primes_found.push_back(f);
+            } while (n.mod_u64(primes[i]) == 0);
+        }
+    }
+
+    // Остаток без делителей меньше 2^16: простые отделяет тест, составные расщепляет ро-метод
+    std::vector<BigInt> pending;
+    if (n != BigInt(1)) pending.push_back(n);
+    while (!pending.empty()) {
+        BigInt m = std::move(pending.back());
+        pending.pop_back();
+        if (is_probable_prime(m)) {
+            primes_found.push_back(std::move(m));
+            continue;
+        }
+        BigInt d = m;
+        for (uint64_t c = 1; d == m; ++c) d = pollard_brent(m, c);
+        pending.push_back(m / d);
+        pending.push_back(std::move(d));
+    }
+
+    std::sort(primes_found.begin(), primes_found.end());
+    std::vector<std::pair<BigInt, unsigned>> factors;
+    for (BigInt& f : primes_found) {
+        if (!factors.empty() && factors.back().first == f) {
+            ++factors.back().second;
+        } else {
+            factors.emplace_back(std::move(f), 1);
+        }
+    }
+    return factors;
+}
+
+namespace {
+
+constexpr size_t HALF_GCD_THRESHOLD_BITS = 64 * 50; // ниже — только шаги Лемера
+
+// Унимодулярное преобразование пары: (a, b) -> (m00 a + m01 b, m10 a + m11 b).
+// Любая такая матрица сохраняет НОД, поэтому для корректности достаточно следить,
+// чтобы пара оставалась неотрицательной и упорядоченной; точность оценок частных
+// влияет только на скорость.
+struct GcdMatrix {
+    BigInt m00{1}, m01{0}, m10{0}, m11{1};
+
+    // this = [[a, b], [c, d]] * this
+    void left_multiply(const BigInt& a, const BigInt& b, const BigInt& c, const BigInt& d) {
+        BigInt n00 = a * m00 + b * m10;
+        BigInt n01 = a * m01 + b * m11;
+        BigInt n10 = c * m00 + d * m10;
+        m11 = c * m01 + d * m11;
+        m00 = std::move(n00);
+        m01 = std::move(n01);
+        m10 = std::move(n10);
+    }
+    void left_multiply(const GcdMatrix& step) { left_multiply(step.m00, step.m01, step.m10, step.m11); }
+};
+
+// (a, b) = M (a, b) с приведением к a >= b >= 0: смена знака или перестановка строк
+// меняет лишь знак определителя
+void apply_matrix(const GcdMatrix& step, BigInt& a, BigInt& b, GcdMatrix& total) {
+    GcdMatrix m = step;
+    BigInt na = m.m00 * a + m.m01 * b;
+    BigInt nb = m.m10 * a + m.m11 * b;
+    if (na.is_negative()) { na = -na; m.m00 = -m.m00; m.m01 = -m.m01; }
+    if (nb.is_negative()) { nb = -nb; m.m10 = -m.m10; m.m11 = -m.m11; }
+    if (na < nb) {
+        std::swap(na, nb);
+        std::swap(m.m00, m.m10);
+        std::swap(m.m01, m.m11);
+    }
+    a = std::move(na);
+    b = std::move(nb);
+    total.left_multiply(m);
+}
+
+// Алгоритм L Кнута (TAOCP 4.5.2): частные по старшим 63 битам a и b (с тем же сдвигом),
+// пока оценки по (ah + A)/(bh + C) и (ah + B)/(bh + D) совпадают. Возвращает false,
+// если ни одного надёжного частного получить не удалось (B == 0).
+bool lehmer_matrix(const BigInt& a, const BigInt& b, int64_t& A, int64_t& B, int64_t& C, int64_t& D) {
+    const size_t shift = a.bit_length() - 63;
+    __int128 ah = (a >> shift).low_u64();
+    __int128 bh = (b >> shift).low_u64();
+    __int128 a0 = 1, b0 = 0, c0 = 0, d0 = 1;
+    while (bh + c0 != 0 && bh + d0 != 0) {
+        const __int128 q = (ah + a0) / (bh + c0);
+        if (q != (ah + b0) / (bh + d0)) break;
+        __int128 t = a0 - q * c0; a0 = c0; c0 = t;
+        t = b0 - q * d0; b0 = d0; d0 = t;
+        t = ah - q * bh; ah = bh; bh = t;
+    }
+    A = (int64_t)a0; B = (int64_t)b0; C = (int64_t)c0; D = (int64_t)d0;
+    return B != 0;
+}
+
+// Один шаг Лемера для a >= b > 0: матрица из одного слова или, если её нет, полное деление
+void lehmer_step(BigInt& a, BigInt& b, GcdMatrix& total) {
+    int64_t A, B, C, D;
+    if (a.bit_length() > 63 && lehmer_matrix(a, b, A, B, C, D)) {
+        BigInt na = a * BigInt(A) + b * BigInt(B);
+        b = a * BigInt(C) + b * BigInt(D);
+        a = std::move(na);
+        total.left_multiply(BigInt(A), BigInt(B), BigInt(C), BigInt(D));
+        return;
+    }
+    BigInt q = a / b;
+    BigInt r = a - q * b;
+    a = std::move(b);
+    b = std::move(r);
+    total.left_multiply(BigInt(0), BigInt(1), BigInt(1), -q);
+}
+
+void half_reduce(BigInt& a, BigInt& b, GcdMatrix& total);
+
+// Сокращение старших бит (a >> k, b >> k), перенесённое на полные a и b одной матрицей
+void reduce_top(BigInt& a, BigInt& b, size_t k, GcdMatrix& total) {
+    BigInt ah = a >> k, bh = b >> k;
+    GcdMatrix step;
+    half_reduce(ah, bh, step);
+    apply_matrix(step, a, b, total);
+}
+
+// Сокращает a >= b >= 0 примерно до половины битовой длины a. Для длинных чисел
+// (схема half-GCD) старшая половина сокращается рекурсивно и переносится на полные
+// числа с быстрым умножением, затем так же второй раз; остаток — шагами Лемера.
+void half_reduce(BigInt& a, BigInt& b, GcdMatrix& total) {
+    const size_t bits = a.bit_length();
+    const size_t target = bits / 2 + 1;
+    // Рекурсия имеет смысл, только пока b сравнимо с a: иначе старшая половина b нулевая
+    // и всю работу делает одно деление в шаге Лемера
+    if (bits > HALF_GCD_THRESHOLD_BITS && b.bit_length() > bits - bits / 4) {
+        // Старшие bits - k бит сокращаются вдвое: результат ~ (bits - k)/2 + k бит
+        reduce_top(a, b, bits / 2, total);
+        const size_t a_bits = a.bit_length();
+        if (b.bit_length() > target && 2 * target > a_bits) {
+            const size_t k = 2 * target - a_bits; // (a_bits - k)/2 + k = target
+            // Вторая рекурсия — только на заметно меньшем числе, иначе глубина не ограничена
+            if (a_bits - k <= bits - bits / 4 && a_bits - k > HALF_GCD_THRESHOLD_BITS / 2) reduce_top(a, b, k, total);
+        }
+    }
+    while (!b.is_zero() && b.bit_length() > target) lehmer_step(a, b, total);
+}
+
+} // namespace
+
 BigInt extended_euclidean(const BigInt& a_in, const BigInt& b_in, BigInt& x, BigInt& y) {
     BigInt a = a_in.abs();
     BigInt b = b_in.abs();
-    BigInt x0(1), y0(0);
-    BigInt x1(0), y1(1);
+    const bool swapped = a < b;
+    if (swapped) std::swap(a, b);
+    const BigInt a_orig = a, b_orig = b;
+
+    // Отслеживается только коэффициент при a_orig: s0 для текущего a, s1 для текущего b
+    BigInt s0(1), s1(0);
     while (!b.is_zero()) {
-        BigInt q = a / b;
-        BigInt r = a % b;
-        BigInt x2 = x0 - q * x1;
-        BigInt y2 = y0 - q * y1;
-        a = b; b = r;
-        x0 = x1; x1 = x2;
-        y0 = y1; y1 = y2;
+        GcdMatrix m;
+        if (b.bit_length() > HALF_GCD_THRESHOLD_BITS) {
+            half_reduce(a, b, m);
+        } else {
+            lehmer_step(a, b, m);
+        }
+        BigInt t = m.m00 * s0 + m.m01 * s1;
+        s1 = m.m10 * s0 + m.m11 * s1;
+        s0 = std::move(t);
+    }
+    BigInt g = a;
+    BigInt cx = s0, cy(0);
+    if (!b_orig.is_zero()) {
+        // Приведение к |cx| <= b/(2g), затем cy из a*cx + b*cy = g
+        const BigInt period = b_orig / g;
+        cx %= period;
+        if (cx.is_negative()) cx += period;
+        if (cx > (period >> 1)) cx -= period;
+        cy = (g - a_orig * cx) / b_orig;
+    }
+    if (swapped) std::swap(cx, cy);
+    // Коэффициенты для исходных знаков: a_in*x + b_in*y = gcd
+    x = a_in.is_negative() ? -cx : cx;
+    y = b_in.is_negative() ? -cy : cy;
+    return g; // gcd
+}
+
+BigInt mod_inverse(const BigInt& a, const BigInt& m) {
+    if (m.is_zero()) throw std::runtime_error("Modulus zero in mod_inverse");
+    const BigInt mod = m.abs();
+    BigInt r = a % mod;
+    if (r.is_negative()) r += mod;
+    BigInt x, y;
+    if (extended_euclidean(r, mod, x, y) != BigInt(1)) throw std::invalid_argument("mod_inverse: value is not invertible");
+    if (x.is_negative()) x += mod;
+    return x;
+}
+
+void batch_mod_inverse(std::vector<BigInt>& values, const BigInt& m) {
+    if (m.is_zero()) throw std::runtime_error("Modulus zero in batch_mod_inverse");
+    const size_t n = values.size();
+    if (n == 0) return;
+    const BigInt mod = m.abs();
+    std::vector<BigInt> a(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = values[i].is_negative() || values[i] >= mod ? values[i] % mod : values[i];
+        if (a[i].is_negative()) a[i] += mod;
+    }
+    if (mod == BigInt(1)) {
+        for (auto& v : values) v = BigInt(0);
+        return;
+    }
+
+    if (!mod.test_bit(0)) {
+        // Чётный модуль: префиксные произведения c_i = a_0...a_i, затем обратный ход от c_{n-1}^{-1}
+        const BarrettReducer br(mod);
+        std::vector<BigInt> prefix(n);
+        prefix[0] = a[0];
+        for (size_t i = 1; i < n; ++i) prefix[i] = br.mul(prefix[i - 1], a[i]);
+        BigInt inv = mod_inverse(prefix[n - 1], mod);
+        for (size_t i = n - 1; i > 0; --i) {
+            values[i] = br.mul(inv, prefix[i - 1]);
+            inv = br.mul(inv, a[i]);
+        }
+        values[0] = std::move(inv);
+        return;
     }
-    x = x0;
-    y = y0;
-    return a; // gcd
+
+    // Нечётный модуль: тот же приём на mont_mul без перевода в форму Монтгомери.
+    // c_i = a_0...a_i * R^{-i}, тогда inv * c_{i-1} * R^{-1} = a_i^{-1} при inv = c_i^{-1},
+    // и множитель R сокращается на каждом шаге обратного хода.
+    const MontgomeryContext ctx(mod);
+    const size_t k = ctx.limbs();
+    std::vector<uint64_t> prefix(n * k), cur(k), inv(k), out(k), scratch(ctx.scratch_limbs());
+    a[0].to_limbs(prefix.data(), k);
+    for (size_t i = 1; i < n; ++i) {
+        a[i].to_limbs(cur.data(), k);
+        ctx.mont_mul(&prefix[i * k], &prefix[(i - 1) * k], cur.data(), scratch.data());
+    }
+    mod_inverse(BigInt::from_limbs(&prefix[(n - 1) * k], k), mod).to_limbs(inv.data(), k);
+    for (size_t i = n - 1; i > 0; --i) {
+        ctx.mont_mul(out.data(), inv.data(), &prefix[(i - 1) * k], scratch.data());
+        a[i].to_limbs(cur.data(), k);
+        ctx.mont_mul(inv.data(), inv.data(), cur.data(), scratch.data());
+        values[i] = BigInt::from_limbs(out.data(), k);
+    }
+    values[0] = BigInt::from_limbs(inv.data(), k);
 }
 
-BigInt generate_random_prime(const BigInt& min_in, const BigInt& max_in) {
+BigInt generate_random_prime(const BigInt& min, const BigInt& max) {
+    return generate_random_prime(min, max, PrimeSearchOptions{});
+}
+
+BigInt generate_random_prime(const BigInt& min_in, const BigInt& max_in, const PrimeSearchOptions& options) {
     BigInt min = min_in;
     BigInt max = max_in;
     if (min > max) std::swap(min, max);
-    uint64_t min_u64, max_u64;
-    if (!bigint_to_u64(min, min_u64) || !bigint_to_u64(max, max_u64)) {
-        throw std::runtime_error("generate_random_prime supports ranges within uint64_t for now");
-    }
-    std::mt19937_64 rng(std::chrono::steady_clock::now().time_since_epoch().count());
-    std::uniform_int_distribution<uint64_t> distrib(min_u64, max_u64);
-    uint64_t num;
-    do {
-        num = distrib(rng);
-    } while (!is_prime_fermat(BigInt((int64_t)num)));
-    return BigInt((int64_t)num);
+    if (max < BigInt(2)) throw std::runtime_error("generate_random_prime: no primes in range");
+    if (min < BigInt(2)) min = BigInt(2);
+    std::mt19937_64 rng(options.seed ? *options.seed : seed_from_clock());
+    MatchPool pool(resolve_threads(options.threads));
+    const PrimalityTest test = PrimalityTest::MillerRabin;
+    // Случайная точка диапазона и поиск вперёд; если до max простых нет — поиск с начала диапазона
+    const BigInt start = min + random_below(max - min + BigInt(1), rng);
+    const uint64_t seed = rng();
+    BigInt p = next_prime_in_range(start, max, options.rounds, test, seed, pool);
+    if (p.is_zero() && start > min) p = next_prime_in_range(min, start - BigInt(1), options.rounds, test, seed, pool);
+    if (p.is_zero()) throw std::runtime_error("generate_random_prime: no primes in range");
+    return p;
 }
@@ -1,117 +1,585 @@
 #include "discrete_log.hpp"
 #include "crypto_lib.hpp"
-#include <unordered_map>
 #include <random>
 #include <chrono>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 using bignum::BigInt;
 
 inline static bool bigint_to_u64_safe(const BigInt& a, uint64_t& out) {
     if (a.is_negative()) return false;
     if (a.bit_length() > 64) return false;
-    try {
-        out = std::stoull(a.to_dec_string());
-        return true;
-    } catch (...) {
-        return false;
+    out = a.low_u64();
+    return true;
+}
+
+namespace {
+
+// Финализатор SplitMix64: равномерно перемешивает биты ключа
+uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+// Арифметика по модулю p < 2^64 во встроенных типах
+struct U64Group {
+    using Elem = uint64_t;
+    uint64_t p;
+
+    Elem one() const { return 1 % p; }
+    Elem mul(Elem x, Elem y) const { return (uint64_t)((__uint128_t)x * y % p); }
+    Elem pow(Elem base, uint64_t e) const {
+        Elem r = one();
+        for (; e; e >>= 1) {
+            if (e & 1) r = mul(r, base);
+            base = mul(base, base);
+        }
+        return r;
     }
+    uint64_t hash(Elem x) const { return mix64(x); }
+    std::string str(Elem x) const { return std::to_string(x); }
+};
+
+// Длинная арифметика с редукцией Барретта; хеш — по младшему limb-у вычета,
+// совпадения старших limb-ов проверяются сравнением элементов при попадании
+struct BigIntGroup {
+    using Elem = BigInt;
+    BigInt p;
+    BarrettReducer br;
+
+    explicit BigIntGroup(const BigInt& modulus) : p(modulus), br(modulus) {}
+    Elem one() const { return br.reduce(BigInt(1)); }
+    Elem mul(const Elem& x, const Elem& y) const { return br.mul(x, y); }
+    Elem pow(const Elem& base, uint64_t e) const { return power_mod(base, BigInt((int64_t)e), p); }
+    uint64_t hash(const Elem& x) const { return mix64(x.low_u64() ^ (uint64_t)x.bit_length() << 56); }
+    std::string str(const Elem& x) const { return x.to_dec_string(); }
+};
+
+unsigned resolve_threads(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    return std::max(threads, 1u);
 }
 
-std::optional<BigInt> discrete_log_bsgs(const BigInt& a, const BigInt& y, const BigInt& p, bool debug) {
-    uint64_t p_u64;
-    if (bigint_to_u64_safe(p, p_u64) && p_u64 != 0) {
-        uint64_t m = (uint64_t)std::ceil(std::sqrt((long double)p_u64));
+// fn(t, lo, hi) для t-го из threads смежных отрезков [lo, hi), покрывающих [0, count)
+template <class Fn>
+void parallel_ranges(uint64_t count, unsigned threads, Fn fn) {
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+        pool.emplace_back(fn, t, count * t / threads, count * (t + 1) / threads);
+    }
+    fn(0u, uint64_t(0), count / threads);
+    for (std::thread& th : pool) th.join();
+}
 
-        uint64_t a_u64, y_u64;
-        if (!bigint_to_u64_safe(a, a_u64) || !bigint_to_u64_safe(y, y_u64)) {
-            return std::nullopt;
+// Таблица шагов малыша с открытой адресацией и линейным пробированием. Запись — один
+// 64-битный слот: j + 1 в младших index_bits_ (0 — пусто), в остальных — отпечаток хеша.
+// Позиция берётся из старших битов хеша, отпечаток — из младших, чтобы они не дублировались.
+// При заполнении 0.8 это около 10 байт на запись. Сами элементы не хранятся: совпадение
+// отпечатка — только кандидат, его подтверждает verify. Вставка — CAS в пустой слот,
+// поэтому потоки заполняют таблицу одновременно. Повторный элемент (a малого порядка)
+// не занимает новый слот, а поднимает j уже имеющейся записи: иначе ord(a)-кратные
+// повторы сливаются в один кластер пробирования и построение становится квадратичным.
+class BabyStepTable {
+public:
+    explicit BabyStepTable(uint64_t entries)
+        : capacity_(entries + entries / 4 + 1), index_bits_(bit_width(entries)),
+          slots_(new std::atomic<uint64_t>[capacity_]) {
+        for (uint64_t i = 0; i < capacity_; ++i) slots_[i].store(0, std::memory_order_relaxed);
+    }
+
+    // same(k) — совпадает ли элемент с шагом k со вставляемым
+    template <class Same>
+    void insert(uint64_t hash, uint64_t j, Same same) {
+        const uint64_t fp = fingerprint(hash);
+        const uint64_t slot = (fp << index_bits_) | (j + 1);
+        const uint64_t index_mask = (uint64_t(1) << index_bits_) - 1;
+        for (uint64_t pos = home(hash);; pos = next(pos)) {
+            uint64_t current = slots_[pos].load(std::memory_order_relaxed);
+            while (true) {
+                if (current == 0) {
+                    if (slots_[pos].compare_exchange_weak(current, slot, std::memory_order_relaxed)) return;
+                    continue;
+                }
+                if ((current >> index_bits_) != fp) break;
+                const uint64_t k = (current & index_mask) - 1;
+                if (!same(k)) break;
+                if (k >= j) return;
+                if (slots_[pos].compare_exchange_weak(current, slot, std::memory_order_relaxed)) return;
+            }
         }
+    }
+
+    // Наибольший j с совпавшим отпечатком, для которого verify(j) истинно
+    template <class Verify>
+    std::optional<uint64_t> find(uint64_t hash, Verify verify) const {
+        const uint64_t fp = fingerprint(hash);
+        const uint64_t index_mask = (uint64_t(1) << index_bits_) - 1;
+        std::optional<uint64_t> best;
+        for (uint64_t pos = home(hash);; pos = next(pos)) {
+            const uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+            if (slot == 0) return best;
+            if ((slot >> index_bits_) != fp) continue;
+            const uint64_t j = (slot & index_mask) - 1;
+            if ((!best || j > *best) && verify(j)) best = j;
+        }
+    }
+
+private:
+    static unsigned bit_width(uint64_t x) {
+        unsigned bits = 0;
+        while (x >> bits) ++bits;
+        return std::max(bits, 1u);
+    }
+    uint64_t fingerprint(uint64_t hash) const { return hash & (~uint64_t(0) >> index_bits_); }
+    // Позиция по старшим битам хеша: (hash * capacity) >> 64
+    uint64_t home(uint64_t hash) const { return (uint64_t)(((unsigned __int128)hash * capacity_) >> 64); }
+    uint64_t next(uint64_t pos) const { return pos + 1 == capacity_ ? 0 : pos + 1; }
+
+    uint64_t capacity_;
+    unsigned index_bits_; // хватает на j + 1 <= entries
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+};
 
-        // Baby steps: a^{j} * y mod p
-        std::unordered_map<uint64_t, uint64_t> table;
-        uint64_t aj = 1 % p_u64;
-        for (uint64_t j = 0; j < m; ++j) {
-            uint64_t val = ( (__uint128_t)aj * y_u64) % p_u64;
-            table[val] = j;
-            if (debug) std::cout << "baby j=" << j << " val=" << val << std::endl;
-            aj = ( (__uint128_t)aj * a_u64) % p_u64;
+// Байт таблицы на один шаг малыша: слот 8 байт при заполнении 0.8
+constexpr uint64_t BSGS_BYTES_PER_ENTRY = 10;
+
+// Пара (i, j) с наименьшим x = i*m - j (0 <= i <= giant, 0 <= j < m), для которой a^x = y,
+// т.е. a^j * y = (a^m)^i. В многопоточном режиме поток t считает шаги малыша со своего
+// a^(t*m/T) * y прямо в общую таблицу. Шаги великана делятся на отрезки; найденное i
+// отменяет все отрезки дальше него.
+template <class Group>
+std::optional<std::pair<uint64_t, uint64_t>> bsgs(const Group& g, const typename Group::Elem& a,
+                                                  const typename Group::Elem& y, uint64_t m, uint64_t giant,
+                                                  unsigned threads, bool debug) {
+    using Elem = typename Group::Elem;
+    // Потоки на этап — не больше, чем по отрезку из 1024 шагов
+    auto threads_for = [threads](uint64_t steps) {
+        return (unsigned)std::min<uint64_t>(threads, std::max<uint64_t>(steps / 1024, 1));
+    };
+
+    // Таблица хранит для каждого элемента наибольший j, а при i = 0 годится только j = 0
+    if (y == g.one()) return std::make_pair(uint64_t(0), uint64_t(0));
+
+    // Baby steps: a^{j} * y
+    BabyStepTable table(m);
+    parallel_ranges(m, threads_for(m), [&](unsigned, uint64_t lo, uint64_t hi) {
+        Elem val = g.mul(g.pow(a, lo), y);
+        for (uint64_t j = lo; j < hi; ++j) {
+            if (debug) std::cout << "baby j=" << j << " val=" << g.str(val) << std::endl;
+            table.insert(g.hash(val), j, [&](uint64_t k) { return g.mul(g.pow(a, k), y) == val; });
+            val = g.mul(val, a);
         }
+    });
 
-        // a^{m} mod p
-        uint64_t am = 1 % p_u64;
-        for (uint64_t i = 0; i < m; ++i) am = ( (__uint128_t)am * a_u64) % p_u64;
-
-        uint64_t gamma = 1 % p_u64;
-        for (uint64_t i = 0; i <= m; ++i) {
-            if (debug) std::cout << "giant i=" << i << " gamma=" << gamma << std::endl;
-            auto it = table.find(gamma);
-            if (it != table.end()) {
-                uint64_t j = it->second;
-                uint64_t x = i * m - j;
-                if (debug) std::cout << "match i=" << i << " j=" << j << " x=" << x << std::endl;
-                return BigInt((int64_t)x);
+    // Giant steps: (a^m)^i. Кандидат j подтверждается пересчётом a^j * y;
+    // i*m < j дало бы отрицательный x — такое решение найдётся при большем i
+    const Elem am = g.pow(a, m);
+    const unsigned giant_threads = threads_for(giant + 1);
+    std::atomic<uint64_t> best_i{UINT64_MAX};
+    std::vector<std::pair<uint64_t, uint64_t>> found(giant_threads, {UINT64_MAX, 0}); // (i, j) каждого потока
+    parallel_ranges(giant + 1, giant_threads, [&](unsigned t, uint64_t lo, uint64_t hi) {
+        Elem gamma = g.pow(am, lo);
+        for (uint64_t i = lo; i < hi && i < best_i.load(std::memory_order_relaxed); ++i) {
+            if (debug) std::cout << "giant i=" << i << " gamma=" << g.str(gamma) << std::endl;
+            auto verify = [&](uint64_t j) { return (unsigned __int128)i * m >= j && g.mul(g.pow(a, j), y) == gamma; };
+            if (auto j = table.find(g.hash(gamma), verify)) {
+                found[t] = {i, *j};
+                uint64_t current = best_i.load();
+                while (i < current && !best_i.compare_exchange_weak(current, i)) {}
+                return;
             }
-            gamma = ( (__uint128_t)gamma * am) % p_u64;
+            gamma = g.mul(gamma, am);
         }
+    });
+    const auto best = *std::min_element(found.begin(), found.end());
+    if (best.first == UINT64_MAX) return std::nullopt;
+    return best;
+}
 
-        return std::nullopt;
-    }
+BigInt from_u64(uint64_t v) { return BigInt::from_limbs(&v, 1); }
+
+// ceil(sqrt(n)) для n > 0, не больше cap
+uint64_t ceil_sqrt_capped(const BigInt& n, uint64_t cap) {
+    if (n.bit_length() > 126) return cap;
+    const long double approx = std::ldexp((long double)(n >> 64).low_u64(), 64) + (long double)n.low_u64();
+    uint64_t r = std::min<uint64_t>((uint64_t)std::ceil(std::sqrt(approx)), cap);
+    while (r > 1 && from_u64(r - 1) * from_u64(r - 1) >= n) --r;
+    while (r < cap && from_u64(r) * from_u64(r) < n) ++r;
+    return r;
+}
 
+std::optional<BigInt> bsgs_dispatch(const BigInt& a, const BigInt& y, const BigInt& p_in,
+                                    const DiscreteLogOptions& options, bool debug) {
+    const BigInt p = p_in.abs();
+    if (p < BigInt(2)) return std::nullopt;
+    const BigInt order = options.order ? *options.order : p - BigInt(1);
+    if (order.is_negative() || order.is_zero()) throw std::invalid_argument("discrete_log_bsgs: group order must be positive");
 
-    const uint64_t MAX_M = 10'000'000ULL;
+    // m шагов малыша — сколько позволяет бюджет, но не больше ceil(sqrt(order));
+    // при меньшем m шагов великана становится order / m вместо sqrt(order)
+    const uint64_t budget_entries = options.memory_budget / BSGS_BYTES_PER_ENTRY;
+    if (budget_entries == 0) throw std::invalid_argument("discrete_log_bsgs: memory budget is below one baby step");
+    const uint64_t m = ceil_sqrt_capped(order, budget_entries);
+    const BigInt giant_big = (order + from_u64(m - 1)) / from_u64(m);
+    if (giant_big.bit_length() > 62) {
+        throw std::invalid_argument("discrete_log_bsgs: group order too large for the memory budget");
+    }
+    const uint64_t giant = giant_big.low_u64();
+    const unsigned threads = resolve_threads(options.threads);
 
-    size_t bits = p.bit_length();
-    
-    if (bits > 64*4) {
+    std::optional<std::pair<uint64_t, uint64_t>> match;
+    uint64_t p_u64;
+    if (bigint_to_u64_safe(p, p_u64)) {
+        const U64Group g{p_u64};
+        auto reduce = [&](const BigInt& v) { BigInt r = v % p; if (r.is_negative()) r += p; return r.low_u64(); };
+        match = bsgs(g, reduce(a), reduce(y), m, giant, threads, debug);
+    } else {
+        if (debug) std::cout << "Using BigInt BSGS: m=" << m << " giant=" << giant << std::endl;
+        const BigIntGroup g(p);
+        match = bsgs(g, g.br.reduce(a), g.br.reduce(y), m, giant, threads, debug);
+    }
+    if (!match) return std::nullopt;
+    const BigInt x = from_u64(match->first) * from_u64(m) - from_u64(match->second);
+    if (debug) std::cout << "match i=" << match->first << " j=" << match->second << " x=" << x.to_dec_string() << std::endl;
+    return x;
+}
+
+// Перегрузки без DiscreteLogOptions не бросают: порядок, который не решить в бюджете
+// по умолчанию, означает "логарифм не найден", как и до появления бюджета
+std::optional<BigInt> bsgs_or_nullopt(const BigInt& a, const BigInt& y, const BigInt& p,
+                                      const DiscreteLogOptions& options, bool debug) {
+    try {
+        return bsgs_dispatch(a, y, p, options, debug);
+    } catch (const std::invalid_argument& e) {
+        if (debug) std::cout << e.what() << std::endl;
         return std::nullopt;
     }
+}
+
+} // namespace
+
+std::optional<BigInt> discrete_log_bsgs(const BigInt& a, const BigInt& y, const BigInt& p, bool debug) {
+    return bsgs_or_nullopt(a, y, p, DiscreteLogOptions{}, debug);
+}
+
+std::optional<BigInt> discrete_log_bsgs(const BigInt& a, const BigInt& y, const BigInt& p, const DiscreteLogOptions& options) {
+    return bsgs_dispatch(a, y, p, options, false);
+}
 
-    uint64_t m_approx = 0;
-    if (bits / 2 < 64) m_approx = (1ULL << ((bits + 1) / 2));
-    else return std::nullopt;
-    if (m_approx == 0 || m_approx > MAX_M) {
-
-        std::string pdec = p.to_dec_string();
-        size_t dlen = pdec.size();
-
-        uint64_t m_from_dec = 1;
-        if (dlen / 2 >= 19) return std::nullopt;
-        for (size_t i = 0; i < dlen/2; ++i) m_from_dec *= 10ULL;
-        if (m_from_dec == 0 || m_from_dec > MAX_M) return std::nullopt;
-        m_approx = m_from_dec;
-    }
-
-    uint64_t m = m_approx;
-
-    if (debug) std::cout << "Using BigInt BSGS: m=" << m << " (cap " << MAX_M << ")" << std::endl;
-
-    // Baby steps
-    std::unordered_map<std::string, uint64_t> table;
-    BigInt aj = BigInt(1);
-    for (uint64_t j = 0; j < m; ++j) {
-        BigInt val = (aj * y) % p;
-        std::string key = val.to_dec_string();
-        table.emplace(key, j);
-        if (debug) std::cout << "baby j=" << j << " val=" << key << std::endl;
-        aj = (aj * a) % p;
-    }
-
-    // am = a^m mod p
-    BigInt am = power_mod(a, BigInt((int64_t)m), p);
-    BigInt gamma = BigInt(1);
-    for (uint64_t i = 0; i <= m; ++i) {
-        std::string key = gamma.to_dec_string();
-        if (debug) std::cout << "giant i=" << i << " gamma=" << key << std::endl;
-        auto it = table.find(key);
-        if (it != table.end()) {
-            uint64_t j = it->second;
-            uint64_t x = i * m - j;
-            if (debug) std::cout << "match i=" << i << " j=" << j << " x=" << x << std::endl;
-            return BigInt((int64_t)x);
+std::optional<BigInt> discrete_log_bsgs_parallel(const BigInt& a, const BigInt& y, const BigInt& p, unsigned threads) {
+    DiscreteLogOptions options;
+    options.threads = threads;
+    return bsgs_or_nullopt(a, y, p, options, false);
+}
+
+namespace {
+
+using u128 = unsigned __int128;
+
+constexpr size_t RHO_MULTIPLIERS = 20;     // r-adding walk: 20 множителей (Теске)
+constexpr int RHO_MAX_COLLISIONS = 32;     // столько вырожденных совпадений — и ответа нет
+constexpr uint64_t RHO_BSGS_ORDER = 1 << 20; // меньшие порядки быстрее решает BSGS
+
+BigInt from_u128(u128 v) {
+    const uint64_t limbs[2] = {(uint64_t)v, (uint64_t)(v >> 64)};
+    return BigInt::from_limbs(limbs, 2);
+}
+
+u128 to_u128(const BigInt& v) {
+    return ((u128)(v >> 64).low_u64() << 64) | v.low_u64();
+}
+
+// Точка блуждания X = a^u * y^v, показатели — по модулю порядка n < 2^127
+template <class Elem>
+struct RhoPoint {
+    Elem x;
+    u128 u, v;
+};
+
+// r-adding walk: X -> X * M_k, где k выбирается по хешу X, а M_k = a^s_k * y^t_k
+template <class Group>
+class RhoWalk {
+public:
+    using Elem = typename Group::Elem;
+    using Point = RhoPoint<Elem>;
+
+    RhoWalk(const Group& g, const Elem& a, const Elem& y, u128 n, std::mt19937_64& rng) : g_(g), a_(a), y_(y), n_(n) {
+        for (size_t k = 0; k < RHO_MULTIPLIERS; ++k) {
+            s_[k] = rng() % n;
+            t_[k] = rng() % n;
+            m_[k] = g.mul(g.pow(a, (uint64_t)s_[k]), g.pow(y, (uint64_t)t_[k]));
         }
-        gamma = (gamma * am) % p;
     }
 
+    Point start(std::mt19937_64& rng) const {
+        const uint64_t u = rng() % n_, v = rng() % n_;
+        return {g_.mul(g_.pow(a_, u), g_.pow(y_, v)), u, v};
+    }
+
+    void step(Point& pt) const {
+        const size_t k = g_.hash(pt.x) % RHO_MULTIPLIERS;
+        pt.x = g_.mul(pt.x, m_[k]);
+        pt.u = add_mod(pt.u, s_[k]);
+        pt.v = add_mod(pt.v, t_[k]);
+    }
+
+private:
+    u128 add_mod(u128 x, u128 d) const {
+        x += d;
+        return x >= n_ ? x - n_ : x;
+    }
+
+    const Group& g_;
+    Elem a_, y_;
+    u128 n_;
+    Elem m_[RHO_MULTIPLIERS];
+    u128 s_[RHO_MULTIPLIERS], t_[RHO_MULTIPLIERS];
+};
+
+// Из a^u1 * y^v1 = a^u2 * y^v2 следует x*(v1 - v2) = u2 - u1 (mod n). При d = gcd(v1 - v2, n) > 1
+// решений d, каждое проверяется возведением в степень; слишком большое d считается неудачей.
+std::optional<BigInt> solve_rho_collision(u128 u1, u128 v1, u128 u2, u128 v2, const BigInt& n,
+                                          const BigInt& a, const BigInt& y, const BigInt& p) {
+    BigInt dv = (from_u128(v1) - from_u128(v2)) % n;
+    if (dv.is_negative()) dv += n;
+    BigInt du = (from_u128(u2) - from_u128(u1)) % n;
+    if (du.is_negative()) du += n;
+    BigInt s, t;
+    const BigInt d = dv.is_zero() ? n : extended_euclidean(dv, n, s, t);
+    if (d > BigInt(1 << 16) || !(du % d).is_zero()) return std::nullopt;
+    const BigInt n_d = n / d;
+    const BigInt x0 = n_d == BigInt(1) ? BigInt(0) : multiply_mod(du / d, mod_inverse(dv / d, n_d), n_d);
+    for (BigInt x = x0; x < n; x += n_d) {
+        if (power_mod(a, x, p) == y) return x;
+    }
     return std::nullopt;
 }
+
+// Порядок вычетов модуля p: U64Group для p < 2^64, иначе длинная арифметика.
+// fn(g, a, y) получает группу и приведённые по модулю p элементы.
+template <class Fn>
+auto with_group(const BigInt& a, const BigInt& y, const BigInt& p, Fn fn) {
+    uint64_t p_u64;
+    if (bigint_to_u64_safe(p, p_u64)) {
+        auto reduce = [&](const BigInt& v) { BigInt r = v % p; if (r.is_negative()) r += p; return r.low_u64(); };
+        return fn(U64Group{p_u64}, reduce(a), reduce(y));
+    }
+    const BigIntGroup g(p);
+    return fn(g, g.br.reduce(a), g.br.reduce(y));
+}
+
+// Последовательный rho: цикл блуждания находится методом Брента (черепаха переносится
+// в позицию зайца на степенях двойки), память O(1)
+template <class Group>
+std::optional<BigInt> rho_sequential(const Group& g, const typename Group::Elem& a, const typename Group::Elem& y,
+                                     const BigInt& order, const BigInt& a_big, const BigInt& y_big, const BigInt& p,
+                                     uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    const u128 n = to_u128(order);
+    for (int attempt = 0; attempt < RHO_MAX_COLLISIONS; ++attempt) {
+        const RhoWalk<Group> walk(g, a, y, n, rng);
+        auto hare = walk.start(rng);
+        auto tortoise = hare;
+        for (uint64_t power = 1, lam = 1;; ++lam) {
+            if (power == lam) {
+                tortoise = hare;
+                power <<= 1;
+                lam = 0;
+            }
+            walk.step(hare);
+            if (hare.x == tortoise.x) break;
+        }
+        if (auto x = solve_rho_collision(tortoise.u, tortoise.v, hare.u, hare.v, order, a_big, y_big, p)) return x;
+    }
+    return std::nullopt;
+}
+
+// Параллельный rho ван Ооршота–Винера: блуждания с общими множителями стартуют из случайных
+// точек и сохраняют в общую таблицу только выделенные точки (хеш с dp_bits нулевыми битами).
+// Два блуждания, попав в одну точку, дальше идут вместе и встречаются на ближайшей выделенной.
+template <class Group>
+std::optional<BigInt> rho_distinguished(const Group& g, const typename Group::Elem& a, const typename Group::Elem& y,
+                                        const BigInt& order, const BigInt& a_big, const BigInt& y_big,
+                                        const BigInt& p, unsigned threads, uint64_t seed) {
+    using Point = RhoPoint<typename Group::Elem>;
+    std::mt19937_64 rng(seed);
+    const u128 n = to_u128(order);
+    const RhoWalk<Group> walk(g, a, y, n, rng);
+    // Около sqrt(order) / 2^dp_bits выделенных точек: ~2^(bits/4 + 2) записей в таблице
+    const unsigned dp_bits = std::min(24, std::max(0, (int)order.bit_length() / 4 - 2));
+    const uint64_t dp_mask = (uint64_t(1) << dp_bits) - 1;
+    const uint64_t max_trail = uint64_t(20) << dp_bits; // без выделенной точки так долго — блуждание зациклилось
+
+    std::mutex mutex;
+    std::unordered_multimap<uint64_t, Point> points;
+    std::optional<BigInt> result;
+    std::atomic<bool> done{false};
+    int failures = 0;
+
+    auto walker = [&](unsigned t) {
+        std::mt19937_64 local(seed ^ (0x9e3779b97f4a7c15ULL * (t + 1)));
+        Point pt = walk.start(local);
+        uint64_t trail = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            walk.step(pt);
+            const uint64_t h = g.hash(pt.x);
+            if ((h >> 40 & dp_mask) != 0) {
+                if (++trail > max_trail) {
+                    pt = walk.start(local);
+                    trail = 0;
+                }
+                continue;
+            }
+            trail = 0;
+            std::lock_guard<std::mutex> lock(mutex);
+            if (done) return;
+            bool restart = false;
+            auto range = points.equal_range(h);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (!(it->second.x == pt.x)) continue;
+                if (auto x = solve_rho_collision(it->second.u, it->second.v, pt.u, pt.v, order, a_big, y_big, p)) {
+                    result = x;
+                    done = true;
+                    return;
+                }
+                // Вырожденное совпадение: этот путь уже известен, начинаем новый
+                if (++failures >= RHO_MAX_COLLISIONS) {
+                    done = true;
+                    return;
+                }
+                restart = true;
+                break;
+            }
+            if (restart) {
+                pt = walk.start(local);
+            } else {
+                points.emplace(h, pt);
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(walker, t);
+    walker(0);
+    for (std::thread& th : pool) th.join();
+    return result;
+}
+
+std::optional<BigInt> rho_dispatch(const BigInt& a_in, const BigInt& y_in, const BigInt& p_in, const BigInt& order,
+                                   unsigned threads, bool parallel) {
+    const BigInt p = p_in.abs();
+    if (p < BigInt(2)) return std::nullopt;
+    // Проверка совпадения сравнивает a^x с y, поэтому оба приводятся в [0, p) сразу
+    BigInt a = a_in % p, y = y_in % p;
+    if (a.is_negative()) a += p;
+    if (y.is_negative()) y += p;
+    if (order.is_negative() || order.is_zero()) throw std::invalid_argument("discrete_log_rho: group order must be positive");
+    if (order.bit_length() > 126) throw std::invalid_argument("discrete_log_rho: group order must be below 2^126");
+    // y из <a> обязан удовлетворять y^order = 1: иначе блуждать бессмысленно
+    if (!(power_mod(y, order, p) == BigInt(1) % p)) return std::nullopt;
+    if (order < BigInt((int64_t)RHO_BSGS_ORDER)) {
+        DiscreteLogOptions options;
+        options.order = order;
+        return discrete_log_bsgs(a, y, p, options);
+    }
+    const uint64_t seed = std::chrono::steady_clock::now().time_since_epoch().count();
+    return with_group(a, y, p, [&](const auto& g, const auto& a_g, const auto& y_g) {
+        if (parallel) return rho_distinguished(g, a_g, y_g, order, a, y, p, threads, seed);
+        return rho_sequential(g, a_g, y_g, order, a, y, p, seed);
+    });
+}
+
+} // namespace
+
+std::optional<BigInt> discrete_log_rho(const BigInt& a, const BigInt& y, const BigInt& p, const BigInt& order) {
+    return rho_dispatch(a, y, p, order, 1, false);
+}
+
+std::optional<BigInt> discrete_log_rho_parallel(const BigInt& a, const BigInt& y, const BigInt& p, const BigInt& order,
+                                                unsigned threads) {
+    return rho_dispatch(a, y, p, order, resolve_threads(threads), true);
+}
+
+namespace {
+
+// Логарифм в подгруппе простого порядка q: малые q — BSGS в пределах бюджета памяти, большие — rho
+std::optional<BigInt> prime_order_log(const BigInt& g, const BigInt& h, const BigInt& p, const BigInt& q,
+                                      const DiscreteLogOptions& options) {
+    if (q < BigInt((int64_t)RHO_BSGS_ORDER)) {
+        DiscreteLogOptions sub;
+        sub.memory_budget = options.memory_budget;
+        sub.order = q;
+        return bsgs_dispatch(g, h, p, sub, false);
+    }
+    if (options.threads == 1) return rho_dispatch(g, h, p, q, 1, false);
+    return rho_dispatch(g, h, p, q, resolve_threads(options.threads), true);
+}
+
+} // namespace
+
+std::optional<BigInt> discrete_log_pohlig_hellman(const BigInt& a_in, const BigInt& y_in, const BigInt& p_in,
+                                                  const DiscreteLogOptions& options) {
+    const BigInt p = p_in.abs();
+    if (p < BigInt(2)) return std::nullopt;
+    const BigInt n = options.order ? *options.order : p - BigInt(1);
+    if (n.is_negative() || n.is_zero()) throw std::invalid_argument("discrete_log_pohlig_hellman: group order must be positive");
+    BigInt a = a_in % p, y = y_in % p;
+    if (a.is_negative()) a += p;
+    if (y.is_negative()) y += p;
+    const BigInt one = BigInt(1) % p;
+    if (y == one) return BigInt(0);
+    BigInt s, t;
+    if (extended_euclidean(a, p, s, t) != BigInt(1)) return std::nullopt;
+
+    // x mod q^f для каждого простого q | n, где q^f — q-часть порядка a (f <= e), затем КТО.
+    // Произведение модулей q^f равно порядку a, поэтому результат — наименьший x >= 0.
+    BigInt x(0), modulus(1);
+    for (const auto& [q, e] : factorize(n)) {
+        BigInt q_e = q.pow((uint64_t)e);
+        const BigInt cofactor = n / q_e;
+        const BigInt g_i = power_mod(a, cofactor, p);
+        BigInt h_i = power_mod(y, cofactor, p);
+
+        // Точный порядок g_i — q^f; h_i из <g_i> обязан лежать в той же подгруппе
+        unsigned f = 0;
+        for (BigInt g_pow = g_i; g_pow != one; g_pow = power_mod(g_pow, q, p)) ++f;
+        if (f == 0) {
+            if (h_i != one) return std::nullopt;
+            continue;
+        }
+        q_e = q.pow((uint64_t)f);
+        if (power_mod(h_i, q_e, p) != one) return std::nullopt;
+
+        // Цифры x_i по основанию q: на шаге k из h_i уже убрана часть g_i^(x_i mod q^k),
+        // и возведение в q^(f-1-k) оставляет одну цифру в подгруппе порядка q
+        const BigInt gamma = power_mod(g_i, q.pow((uint64_t)(f - 1)), p);
+        BigInt g_inv_qk = mod_inverse(g_i, p); // g_i^(-q^k)
+        BigInt x_i(0), q_k(1);
+        for (unsigned k = 0; k < f; ++k) {
+            const BigInt h_k = power_mod(h_i, q.pow((uint64_t)(f - 1 - k)), p);
+            const std::optional<BigInt> d = prime_order_log(gamma, h_k, p, q, options);
+            if (!d) return std::nullopt;
+            x_i += *d * q_k;
+            h_i = multiply_mod(h_i, power_mod(g_inv_qk, *d, p), p);
+            g_inv_qk = power_mod(g_inv_qk, q, p);
+            q_k *= q;
+        }
+
+        // x = x + modulus * ((x_i - x) * modulus^(-1) mod q^f)
+        x += modulus * multiply_mod(x_i - x, mod_inverse(modulus, q_e), q_e);
+        modulus *= q_e;
+    }
+    if (power_mod(a, x, p) != y) return std::nullopt;
+    return x;
+}
@@ -0,0 +1,100 @@
+#include "rsa.hpp"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using bignum::BigInt;
+
+namespace {
+
+// Простое ровно из bits бит с двумя старшими единичными битами: произведение двух
+// таких чисел из k1 и k2 бит занимает ровно k1 + k2 бит
+BigInt rsa_prime(size_t bits, const BigInt& e, std::mt19937_64& rng, const PrimeSearchOptions& options) {
+    const BigInt min = BigInt(3) << (bits - 2);
+    const BigInt max = (BigInt(1) << bits) - BigInt(1);
+    PrimeSearchOptions sub = options;
+    while (true) {
+        sub.seed = rng();
+        BigInt p = generate_random_prime(min, max, sub);
+        BigInt x, y;
+        if (extended_euclidean(e, p - BigInt(1), x, y) == BigInt(1)) return p;
+    }
+}
+
+void check_message_range(const BigInt& m, const BigInt& n, const char* what) {
+    if (m.is_negative() || m >= n) throw std::invalid_argument(std::string(what) + ": value out of range [0, n)");
+}
+
+} // namespace
+
+RsaPrivateKey rsa_generate_key(size_t bits, const PrimeSearchOptions& options, const BigInt& e) {
+    if (bits < 16) throw std::invalid_argument("rsa_generate_key: modulus must be at least 16 bits");
+    std::mt19937_64 rng(options.seed ? *options.seed : std::chrono::steady_clock::now().time_since_epoch().count());
+    while (true) {
+        BigInt p = rsa_prime(bits - bits / 2, e, rng, options);
+        BigInt q = rsa_prime(bits / 2, e, rng, options);
+        if (p != q) return rsa_key_from_primes(p, q, e);
+    }
+}
+
+RsaPrivateKey rsa_key_from_primes(const BigInt& p_in, const BigInt& q_in, const BigInt& e) {
+    if (p_in == q_in) throw std::invalid_argument("rsa_key_from_primes: p and q must differ");
+    if (p_in < BigInt(3) || q_in < BigInt(3) || !p_in.test_bit(0) || !q_in.test_bit(0)) {
+        throw std::invalid_argument("rsa_key_from_primes: p and q must be odd primes");
+    }
+    if (e < BigInt(3) || !e.test_bit(0)) throw std::invalid_argument("rsa_key_from_primes: e must be odd and at least 3");
+    RsaPrivateKey key;
+    // p > q: склейка Гарнера идёт через q^{-1} mod p
+    key.p = std::max(p_in, q_in);
+    key.q = std::min(p_in, q_in);
+    key.n = key.p * key.q;
+    key.e = e;
+    const BigInt p1 = key.p - BigInt(1);
+    const BigInt q1 = key.q - BigInt(1);
+    BigInt x, y;
+    const BigInt lambda = p1 / extended_euclidean(p1, q1, x, y) * q1;
+    key.d = mod_inverse(e, lambda);
+    key.dp = key.d % p1;
+    key.dq = key.d % q1;
+    key.q_inv = mod_inverse(key.q, key.p);
+    return key;
+}
+
+RsaPublicEngine::RsaPublicEngine(const RsaPublicKey& key) : key_(key), ctx_n_(key.n) {}
+
+BigInt RsaPublicEngine::encrypt(const BigInt& m) const {
+    check_message_range(m, key_.n, "RsaPublicEngine::encrypt");
+    return ctx_n_.pow(m, key_.e);
+}
+
+bool RsaPublicEngine::verify(const BigInt& m, const BigInt& signature) const {
+    if (m.is_negative() || m >= key_.n || signature.is_negative() || signature >= key_.n) return false;
+    return ctx_n_.pow(signature, key_.e) == m;
+}
+
+RsaPrivateEngine::RsaPrivateEngine(const RsaPrivateKey& key)
+    : key_(key), public_(key.public_key()), ctx_p_(key.p), ctx_q_(key.q) {}
+
+BigInt RsaPrivateEngine::crt_pow(const BigInt& c) const {
+    const BigInt mp = ctx_p_.pow(c, key_.dp);
+    const BigInt mq = ctx_q_.pow(c, key_.dq);
+    // Гарнер: h = q_inv * (m_p - m_q) mod p, m = m_q + h * q
+    BigInt diff = mp - mq;
+    if (diff.is_negative()) diff += key_.p;
+    const BigInt h = ctx_p_.mul(diff, key_.q_inv);
+    return mq + h * key_.q;
+}
+
+BigInt RsaPrivateEngine::decrypt(const BigInt& c) const {
+    check_message_range(c, key_.n, "RsaPrivateEngine::decrypt");
+    return crt_pow(c);
+}
+
+BigInt RsaPrivateEngine::sign(const BigInt& m) const {
+    check_message_range(m, key_.n, "RsaPrivateEngine::sign");
+    BigInt s = crt_pow(m);
+    if (!public_.verify(m, s)) throw std::runtime_error("RsaPrivateEngine::sign: CRT result failed verification");
+    return s;
+}
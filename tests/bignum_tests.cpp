@@ -1,4 +1,5 @@
 #include "bignum/bignum.hpp"
+#include "bignum/barrett.hpp"
 #include <cassert>
 #include <cassert>
 #include <iostream>
@@ -40,6 +41,21 @@ void test_edge_cases() {
     BigInt neg("-123");
     assert(neg.is_negative());
     assert(neg.abs().to_dec_string() == "123");
+    // Перемещение малых (inline) и больших (в куче) значений
+    BigInt small(-42);
+    BigInt moved_small(std::move(small));
+    assert(moved_small.to_dec_string() == "-42");
+    assert(small.is_zero());
+    BigInt large = BigInt(1) << 1000;
+    BigInt moved_large(std::move(large));
+    assert(moved_large.bit_length() == 1001);
+    assert(large.is_zero());
+    large = std::move(moved_small);
+    assert(large.to_dec_string() == "-42");
+    moved_small = std::move(moved_large);
+    assert(moved_small.bit_length() == 1001);
+    large = moved_small;
+    assert(large == moved_small);
 }
 
 void test_exceptions() {
@@ -102,6 +118,95 @@ void test_multiplication() {
     assert((BigInt("0") * BigInt("12345678901234567890")).is_zero());
 }
 
+void test_large_multiplication() {
+    using bignum::BigInt;
+    // Сбалансированные операнды в зоне рекурсивной Карацубы (нечётные размеры, без выравнивания до 2^k)
+    BigInt x = BigInt(3).pow(9000) + BigInt(11);   // ~225 limb-ов
+    BigInt y = BigInt(7).pow(5000) - BigInt(5);    // ~220 limb-ов
+    BigInt xy = x * y;
+    assert(xy / y == x && (xy % y).is_zero());
+    assert((x + BigInt(1)) * (x - BigInt(1)) == x * x - BigInt(1));
+    // Максимальные переносы: (2^n - 1)^2 = 2^2n - 2^(n+1) + 1
+    BigInt ones = (BigInt(1) << 6400) - BigInt(1);
+    assert(ones * ones == (BigInt(1) << 12800) - (BigInt(1) << 6401) + BigInt(1));
+    // Несбалансированные операнды: 40 limb-ов на ~1100
+    BigInt s = BigInt(5).pow(1100) + BigInt(3);
+    BigInt big = BigInt(3).pow(44000) - BigInt(1);
+    BigInt sb = s * big;
+    assert(sb == big * s);
+    assert(sb / s == big && (sb % s).is_zero());
+    assert(sb / big == s && (sb % big).is_zero());
+    // Тоом-3 (~300 limb-ов) и Тоом-4 (~1000 limb-ов), в т.ч. отрицательные и несбалансированные
+    BigInt t3a = (BigInt(1) << 19200) - BigInt(3).pow(9000);
+    BigInt t3b = -((BigInt(1) << 19000) - BigInt(1));
+    BigInt t3 = t3a * t3b;
+    assert(t3.is_negative());
+    assert(t3 / t3b == t3a && (t3 % t3b).is_zero());
+    assert(t3 / t3a == t3b && (t3 % t3a).is_zero());
+    BigInt t4a = BigInt(3).pow(40000) + BigInt(1);
+    BigInt t4b = (BigInt(1) << 64000) - BigInt(1);
+    BigInt t4 = t4a * t4b;
+    assert(t4 == (t4a << 64000) - t4a);
+    BigInt t4c = BigInt(5).pow(12000) - BigInt(7);
+    BigInt t4d = t4a * t4c;
+    assert(t4d / t4c == t4a && (t4d % t4c).is_zero());
+    // NTT (от ~16000 limb-ов): тождество для 2^n - 1 и сверка вычетов по 64-битному простому
+    BigInt na = BigInt(3).pow(41), nc = BigInt(7).pow(23);
+    for (int i = 0; i < 14; ++i) { // по ~16600 limb-ов
+        na = na * na + BigInt(1);
+        nc = nc * nc - BigInt(3);
+    }
+    BigInt nb = (BigInt(1) << 1100000) - BigInt(1); // ~17200 limb-ов
+    assert(na * nb == (na << 1100000) - na);
+    BigInt q("0xffffffffffffffc5");
+    assert((na * nc) % q == ((na % q) * (nc % q)) % q);
+    assert(na * na == na * BigInt(na));
+}
+
+void test_squaring() {
+    using bignum::BigInt;
+    assert(BigInt(0).sqr().is_zero());
+    assert(BigInt(-7).sqr().to_dec_string() == "49");
+    assert(BigInt("0xffffffffffffffff").sqr().to_hex_string() == "0xfffffffffffffffe0000000000000001");
+    // Школьный, Карацуба, Тоом-3 и Тоом-4: сверка с общим умножением на копию
+    for (size_t bits : {200, 3000, 6200, 15000, 40000, 100000}) {
+        BigInt x = (BigInt(1) << bits) - BigInt(3).pow(bits / 8);
+        BigInt copy = x;
+        assert(x.sqr() == x * copy);
+        assert(x * x == x.sqr());
+        assert((-x).sqr() == x.sqr());
+    }
+    // Все limb-ы единичные: максимальные переносы при удвоении
+    BigInt ones = (BigInt(1) << 4096) - BigInt(1);
+    assert(ones.sqr() == (BigInt(1) << 8192) - (BigInt(1) << 4097) + BigInt(1));
+}
+
+void test_barrett() {
+    using bignum::BigInt;
+    using bignum::BarrettReducer;
+    // Однолимбовый, школьный и длинный (через быстрое умножение) модули; 2^(64*3) — mu на limb длиннее
+    for (const BigInt& n : {BigInt(1000003), (BigInt(1) << 127) - BigInt(1), BigInt(1) << 192,
+                            BigInt(3).pow(400), (BigInt(1) << 2500) - BigInt(3).pow(700)}) {
+        const BarrettReducer br(n);
+        assert(br.modulus() == n);
+        BigInt a = n - BigInt(1);
+        BigInt b = n / BigInt(3) + BigInt(12345);
+        assert(br.mul(a, a) == (a * a) % n);
+        assert(br.mul(a, b) == (a * b) % n);
+        assert(br.sqr(b) == (b * b) % n);
+        assert(br.reduce(n) == BigInt(0));
+        assert(br.reduce(BigInt(5)) == BigInt(5) % n);
+        assert(br.reduce(-a * b) == n - (a * b) % n);
+        BigInt huge = a.pow(5); // длиннее 2k limb-ов — обычное деление
+        assert(br.reduce(huge) == huge % n);
+        assert(br.mul(-a, huge) == ((-a * huge) % n + n) % n);
+    }
+    assert(BarrettReducer(BigInt(1)).mul(BigInt(7), BigInt(9)).is_zero());
+    bool thrown = false;
+    try { BarrettReducer zero(BigInt(0)); } catch (const std::invalid_argument&) { thrown = true; }
+    assert(thrown);
+}
+
 void test_division() {
     using bignum::BigInt;
     BigInt a("121932631112635269");
@@ -112,6 +217,43 @@ void test_division() {
     assert(d.is_zero());
     assert((BigInt("100") / BigInt("3")).to_dec_string() == "33");
     assert((BigInt("100") % BigInt("3")).to_dec_string() == "1");
+    // Многолимбовое деление (алгоритм D), python-сверка
+    // Случай с коррекцией "add back" (шаг D6)
+    BigInt u("0x7fffffffffffffff800000000000000000000000000000000000000000000000");
+    BigInt v("0x800000000000000000000000000000000000000000000001");
+    assert((u / v).to_hex_string() == "0xfffffffffffffffe");
+    assert((u % v).to_hex_string() == "0x7fffffffffffffffffffffffffffffff0000000000000002");
+    BigInt all_ones = (BigInt(1) << 512) - BigInt(1);
+    BigInt divisor = (BigInt(1) << 256) + BigInt(1);
+    assert((all_ones / divisor).to_hex_string() == "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    assert((all_ones % divisor).is_zero());
+    // Делитель из одного limb-а
+    BigInt p3 = BigInt(3).pow(300);
+    BigInt q64("0xffffffffffffffc5");
+    assert((p3 / q64).to_hex_string() == "0xb39cfff485a5dc1e3bd9dd8b8655b60691f1b2b1c34e73095e57c7541cda6576ff003403ca1c42956d7fe6c31bd173b6601e7ad");
+    assert((p3 % q64).to_hex_string() == "0xb047a9185ecc8b50");
+    BigInt p7 = BigInt(7).pow(250) + BigInt(12345);
+    BigInt p5 = BigInt(5).pow(60);
+    assert((p7 / p5).to_hex_string() == "0x5bf78f2d43c7401b726483d7d1c360843d9eea57eebaa0ba75206aa10b78fcdba591d0a4fe3ba84e1d6e0db9d1e3caf81cdefa07d4478defe7024ed80d5df04c8c528f9884b23");
+    assert((p7 % p5).to_hex_string() == "0x8f6c94827a563034558d634d540df1c87d7");
+}
+
+void test_large_decimal_conversion() {
+    using bignum::BigInt;
+    // Длинные числа идут через рекурсивное преобразование по степеням 10^(19*2^k)
+    BigInt ten_1200 = BigInt(10).pow(1200);
+    assert(ten_1200.to_dec_string() == "1" + std::string(1200, '0'));
+    BigInt nines(std::string(1200, '9'));
+    assert(nines + BigInt(1) == ten_1200);
+    assert((ten_1200 - BigInt(1)).to_dec_string() == std::string(1200, '9'));
+    assert((-nines).to_dec_string() == "-" + std::string(1200, '9'));
+    // Нули внутри младших блоков должны сохраняться
+    BigInt sparse = ten_1200 + BigInt(7);
+    assert(sparse.to_dec_string() == "1" + std::string(1199, '0') + "7");
+    assert(BigInt(sparse.to_dec_string()) == sparse);
+    // Круговое преобразование для числа без регулярной структуры
+    BigInt x = BigInt(3).pow(7000) + BigInt(12345);
+    assert(BigInt(x.to_dec_string()) == x);
 }
 
 void test_comparison() {
@@ -201,6 +343,57 @@ void test_negative_mixed_arithmetic() {
     assert(!BigInt("123").is_negative());
 }
 
+void test_compound_assignment() {
+    using bignum::BigInt;
+    // Перенос через все limb-ы и рост ёмкости
+    BigInt a("0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    a += BigInt(1);
+    assert(a.to_hex_string() == "0x10000000000000000000000000000000000000000000000000000000000000000");
+    a -= BigInt(1);
+    assert(a.to_hex_string() == "0xffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    // Смена знака
+    BigInt b(5);
+    b -= BigInt(8);
+    assert(b.to_dec_string() == "-3");
+    b += BigInt(10);
+    assert(b.to_dec_string() == "7");
+    b -= BigInt(-3);
+    assert(b.to_dec_string() == "10");
+    BigInt z(0);
+    z -= BigInt(4);
+    assert(z.to_dec_string() == "-4");
+    // Самоприсваивание
+    BigInt c("12345678901234567890123456789");
+    c += c;
+    assert(c.to_dec_string() == "24691357802469135780246913578");
+    c -= c;
+    assert(c.is_zero() && !c.is_negative());
+    BigInt d("-98765432109876543210");
+    d *= d;
+    assert(d.to_dec_string() == "9754610579850632525677488187778997104100");
+    // Умножение и деление на один limb
+    BigInt e("-123456789012345678901234567890");
+    e *= BigInt(1000);
+    assert(e.to_dec_string() == "-123456789012345678901234567890000");
+    e /= BigInt(-7);
+    assert(e.to_dec_string() == "17636684144620811271604938270000");
+    e %= BigInt(97);
+    assert(e.to_dec_string() == (BigInt("17636684144620811271604938270000") % BigInt(97)).to_dec_string());
+    BigInt f("-100");
+    f %= BigInt(7);
+    assert(f.to_dec_string() == "-2");
+    f /= BigInt(3);
+    assert(f.is_zero() && !f.is_negative());
+    // Побитовые in-place для неотрицательных
+    BigInt g("0xff00ff00ff00ff00ff00ff00ff00ff00ff");
+    g &= BigInt("0xf0f0");
+    assert(g.to_hex_string() == "0xf0");
+    g |= BigInt("0xabcd0000000000000000000000");
+    assert(g.to_hex_string() == "0xabcd00000000000000000000f0");
+    g ^= BigInt("0xabcd00000000000000000000f0");
+    assert(g.is_zero());
+}
+
 void test_bitwise_and_utils() {
     using bignum::BigInt;
     // Проверка abs и bit_length
@@ -236,6 +429,19 @@ void test_bitwise_and_utils() {
     assert(t.to_hex_string() == "0xf00");
     t >>= 8;
     assert(t.to_hex_string() == "0xf");
+    // Остаток по одному limb-у и сборка из limb-ов
+    BigInt p3 = BigInt(3).pow(100);
+    assert(p3.mod_u64(1000003) == 189751); // python: 3**100 % 1000003
+    assert(p3.mod_u64(0xffffffffffffffc5ULL) == 0xa0598e085db5770aULL);
+    assert((-p3).mod_u64(1000003) == 189751); // остаток берётся от модуля числа
+    const uint64_t limbs[3] = {0x1, 0xffffffffffffffffULL, 0};
+    assert(BigInt::from_limbs(limbs, 3).to_hex_string() == "0xffffffffffffffff0000000000000001");
+    assert(BigInt::from_limbs(limbs, 0).is_zero());
+    uint64_t out[4] = {7, 7, 7, 7};
+    (-BigInt::from_limbs(limbs, 3)).to_limbs(out, 4);
+    assert(out[0] == 1 && out[1] == 0xffffffffffffffffULL && out[2] == 0 && out[3] == 0);
+    BigInt::from_limbs(limbs, 2).to_limbs(out, 1);
+    assert(out[0] == 1 && out[1] == 0xffffffffffffffffULL);
 }
 
 void test_big_negative_numbers() {
@@ -283,6 +489,19 @@ void test_pow_and_log() {
     BigInt a("123456789");
     BigInt b = a.pow(3);
     assert(b.to_dec_string() == "1881676371789154860897069"); // python: 123456789**3
+    // Скользящее окно: разные ширины окна и знак
+    assert(BigInt(2).pow(2049) == BigInt(1) << 2049);
+    assert(BigInt(2).pow(BigInt(2049)) == BigInt(1) << 2049);
+    assert(BigInt(-3).pow(5).to_dec_string() == "-243");
+    assert(BigInt(-3).pow(BigInt(6)).to_dec_string() == "729");
+    assert(BigInt(0).pow(1000).is_zero());
+    assert(BigInt(-1).pow(UINT64_MAX) == BigInt(-1));
+    assert(BigInt(3).pow(100).to_dec_string() == "515377520732011331036461129765621272702107522001"); // python: 3**100
+    BigInt p = BigInt(12345).pow(1000);
+    assert(p == BigInt(12345).pow(BigInt(1000)));
+    assert(p == BigInt(12345).pow(500).sqr());
+    assert(p == BigInt(12345).pow(999) * BigInt(12345));
+    assert(p % BigInt("0xffffffffffffffc5") == BigInt("0x932790071cef9fce")); // python: pow(12345, 1000, 2**64 - 59)
     // log2
     assert(BigInt(1).log2() == 0);
     assert(BigInt(2).log2() == 1);
@@ -316,12 +535,17 @@ int main() {
     RUN_TEST(test_addition);
     RUN_TEST(test_subtraction);
     RUN_TEST(test_multiplication);
+    RUN_TEST(test_large_multiplication);
+    RUN_TEST(test_squaring);
+    RUN_TEST(test_barrett);
     RUN_TEST(test_division);
+    RUN_TEST(test_large_decimal_conversion);
     RUN_TEST(test_comparison);
     RUN_TEST(test_big_numbers);
     RUN_TEST(test_negative_numbers);
     RUN_TEST(test_negative_mixed_arithmetic);
     RUN_TEST(test_big_negative_numbers);
+    RUN_TEST(test_compound_assignment);
     RUN_TEST(test_bitwise_and_utils);
     RUN_TEST(test_edge_cases);
     RUN_TEST(test_exceptions);
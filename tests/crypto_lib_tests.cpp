@@ -2,6 +2,7 @@
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 int tests_passed = 0;
 int tests_failed = 0;
@@ -17,6 +18,16 @@ void ASSERT_EQUAL(const bignum::BigInt& actual, long long expected, const std::s
     }
 }
 
+// Overload for BigInt vs BigInt
+void ASSERT_EQUAL(const bignum::BigInt& actual, const bignum::BigInt& expected, const std::string& test_name) {
+    if (!(actual == expected)) {
+        std::string error_message = "Assertion failed in " + test_name +
+                                  ": Expected " + expected.to_dec_string() +
+                                  ", but got " + actual.to_dec_string();
+        throw std::runtime_error(error_message);
+    }
+}
+
 // Overload for bool
 void ASSERT_EQUAL(bool actual, bool expected, const std::string& test_name) {
     if (actual != expected) {
@@ -46,6 +57,86 @@ void test_power_mod() {
     ASSERT_EQUAL(power_mod(bignum::BigInt(3), bignum::BigInt(5), bignum::BigInt(13)), 9LL, "3^5 mod 13");
     ASSERT_EQUAL(power_mod(bignum::BigInt(123456789), bignum::BigInt(2), bignum::BigInt(987654321)), 478395063LL, "Large numbers power");
     ASSERT_EQUAL(power_mod(bignum::BigInt(987654321), bignum::BigInt(12345), bignum::BigInt(999999937)), 128540957LL, "Large prime modulus");
+    ASSERT_EQUAL(power_mod(bignum::BigInt(5), bignum::BigInt(0), bignum::BigInt(7)), 1LL, "Zero exponent");
+    ASSERT_EQUAL(power_mod(bignum::BigInt(-2), bignum::BigInt(3), bignum::BigInt(7)), 6LL, "Negative base");
+    ASSERT_EQUAL(power_mod(bignum::BigInt(5), bignum::BigInt(3), bignum::BigInt(1)), 0LL, "Modulus one");
+
+    bignum::BigInt m521 = (bignum::BigInt(1) << 521) - bignum::BigInt(1);
+    bignum::BigInt e521 = (bignum::BigInt(1) << 520) + bignum::BigInt(12345);
+    ASSERT_EQUAL(power_mod(bignum::BigInt(3), e521, m521),
+                 bignum::BigInt("5317293768722524343346515780643144815601808752073572181015995855596891226129122015718717050992216607914619429958849983271292217410615609895901056012762545654"),
+                 "3^(2^520+12345) mod 2^521-1");
+    bignum::BigInt p25519 = (bignum::BigInt(1) << 255) - bignum::BigInt(19);
+    ASSERT_EQUAL(power_mod(bignum::BigInt("0xdeadbeefcafebabe1234567890"), bignum::BigInt(65537), p25519),
+                 bignum::BigInt("5531377681314961237640681501780989669227552062924626690655426010138074360921"),
+                 "x^65537 mod 2^255-19");
+    ASSERT_EQUAL(power_mod(bignum::BigInt(7), bignum::BigInt("1000000000000000000000000000000"), bignum::BigInt(1) << 200),
+                 bignum::BigInt("326029821314112221588723034860097473743894310866730390388737"),
+                 "Even modulus 2^200");
+}
+
+void test_fixed_base_pow_table() {
+    using bignum::BigInt;
+    const BigInt p25519 = (BigInt(1) << 255) - BigInt(19);
+    std::mt19937_64 rng(17);
+    for (unsigned w : {1u, 4u, 7u}) {
+        FixedBasePowTable table(BigInt(2), p25519, 255, w);
+        ASSERT_EQUAL(table.pow(BigInt(0)), 1LL, "Fixed-base zero exponent");
+        ASSERT_EQUAL(table.pow(BigInt(10)), 1024LL, "Fixed-base 2^10");
+        for (int i = 0; i < 5; ++i) {
+            const BigInt e = random_below(BigInt(1) << 255, rng);
+            ASSERT_EQUAL(table.pow(e), power_mod(BigInt(2), e, p25519), "Fixed-base pow matches power_mod");
+        }
+        // Показатель длиннее таблицы считается обычным возведением
+        const BigInt big = (BigInt(1) << 300) + BigInt(3);
+        ASSERT_EQUAL(table.pow(big), power_mod(BigInt(2), big, p25519), "Fixed-base long exponent");
+    }
+    FixedBasePowTable negative(BigInt(-3), BigInt(13), 8);
+    ASSERT_EQUAL(negative.pow(BigInt(5)), power_mod(BigInt(-3), BigInt(5), BigInt(13)), "Fixed-base negative base");
+    bool thrown = false;
+    try { FixedBasePowTable(BigInt(3), BigInt(16), 8); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "FixedBasePowTable rejects even modulus");
+}
+
+void test_multi_power_mod() {
+    using bignum::BigInt;
+    ASSERT_EQUAL(multi_power_mod({BigInt(2), BigInt(3)}, {BigInt(10), BigInt(5)}, BigInt(1000)), 832LL, "2^10 * 3^5 mod 1000");
+    ASSERT_EQUAL(multi_power_mod({}, {}, BigInt(7)), 1LL, "Empty product");
+    ASSERT_EQUAL(multi_power_mod({BigInt(5), BigInt(6)}, {BigInt(0), BigInt(0)}, BigInt(7)), 1LL, "Zero exponents");
+    ASSERT_EQUAL(multi_power_mod({BigInt(-2)}, {BigInt(3)}, BigInt(7)), 6LL, "Negative base");
+
+    const BigInt p = (BigInt(1) << 521) - BigInt(1);
+    std::mt19937_64 rng(18);
+    for (size_t terms : {1, 2, 3, 5}) {
+        std::vector<BigInt> bases, exps;
+        const BigInt even = p << 3;
+        BigInt expected(1), expected_even(1);
+        for (size_t i = 0; i < terms; ++i) {
+            bases.push_back(random_below(p, rng));
+            // Показатели разной длины, включая короткие
+            exps.push_back(random_bigint(i == 1 ? 20 : 521 - 100 * i, rng));
+            expected = multiply_mod(expected, power_mod(bases[i], exps[i], p), p);
+            expected_even = multiply_mod(expected_even, power_mod(bases[i], exps[i], even), even);
+        }
+        ASSERT_EQUAL(multi_power_mod(bases, exps, p), expected, "multi_power_mod matches power_mod product");
+        ASSERT_EQUAL(multi_power_mod(bases, exps, even), expected_even, "multi_power_mod with even modulus");
+    }
+    bool thrown = false;
+    try { multi_power_mod({BigInt(2)}, {BigInt(1), BigInt(2)}, BigInt(7)); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "multi_power_mod rejects size mismatch");
+}
+
+void test_multiply_mod() {
+    bignum::BigInt a = (bignum::BigInt(1) << 300) + bignum::BigInt(17);
+    bignum::BigInt b = bignum::BigInt(3).pow(200) + bignum::BigInt(5);
+    bignum::BigInt m = (bignum::BigInt(1) << 256) - bignum::BigInt(189);
+    ASSERT_EQUAL(multiply_mod(a, b, m),
+                 bignum::BigInt("49490580566195525634479227375902976569103903766524393530901107263412381682970"),
+                 "multiply_mod 256-bit");
+    ASSERT_EQUAL(multiply_mod(bignum::BigInt(-3), bignum::BigInt(4), bignum::BigInt(7)), 2LL, "multiply_mod negative");
+
+    MontgomeryContext ctx(m);
+    ASSERT_EQUAL(ctx.mul(a, b), multiply_mod(a, b, m), "Montgomery mul");
 }
 
 void test_is_prime_fermat() {
@@ -57,6 +148,100 @@ void test_is_prime_fermat() {
     ASSERT_EQUAL(is_prime_fermat(bignum::BigInt(1000000000)), false, "Large composite number");
 }
 
+void test_is_probable_prime() {
+    using bignum::BigInt;
+    ASSERT_EQUAL(is_probable_prime(BigInt(1)), false, "1 is not prime");
+    ASSERT_EQUAL(is_probable_prime(BigInt(2)), true, "2 is prime");
+    ASSERT_EQUAL(is_probable_prime(BigInt(2039)), true, "Largest tabulated prime");
+    ASSERT_EQUAL(is_probable_prime(BigInt(-7)), false, "Negative numbers are not prime");
+    ASSERT_EQUAL(is_probable_prime(BigInt(561)), false, "Carmichael 561");
+    // Сильное псевдопростое по основаниям 2..31, ловится только основанием 37
+    ASSERT_EQUAL(is_probable_prime(BigInt(3825123056546413051LL)), false, "Strong pseudoprime below 2^64");
+    ASSERT_EQUAL(is_probable_prime(BigInt("18446744073709551557")), true, "Largest 64-bit prime");
+    // Число Кармайкла 6000307 * 12000613 * 18000919 > 2^64
+    BigInt carmichael("1296198694153288947529");
+    ASSERT_EQUAL(is_probable_prime(carmichael), false, "Carmichael above 2^64 (MR)");
+    ASSERT_EQUAL(is_probable_prime(carmichael, 0, PrimalityTest::BailliePSW), false, "Carmichael above 2^64 (BPSW)");
+    BigInt m127 = (BigInt(1) << 127) - BigInt(1);
+    BigInt m521 = (BigInt(1) << 521) - BigInt(1);
+    ASSERT_EQUAL(is_probable_prime(m127), true, "2^127 - 1 (MR)");
+    ASSERT_EQUAL(is_probable_prime(m521, 0, PrimalityTest::BailliePSW), true, "2^521 - 1 (BPSW)");
+    ASSERT_EQUAL(is_probable_prime(m127 * m521), false, "Product of two primes");
+    ASSERT_EQUAL(is_probable_prime(m521.sqr(), 0, PrimalityTest::BailliePSW), false, "Square of a prime (BPSW)");
+    ASSERT_EQUAL(is_probable_prime((BigInt(1) << 128) + BigInt(1)), false, "2^128 + 1");
+}
+
+void test_random_and_prime_generation() {
+    using bignum::BigInt;
+    std::mt19937_64 rng(2024);
+    for (size_t bits : {1, 63, 64, 65, 200}) {
+        ASSERT_EQUAL(random_bigint(bits, rng).bit_length() == bits, true, "random_bigint bit length");
+    }
+    BigInt bound = (BigInt(1) << 130) + BigInt(7);
+    bool below = true;
+    for (int i = 0; i < 20; ++i) below = below && random_below(bound, rng) < bound;
+    ASSERT_EQUAL(below, true, "random_below stays below bound");
+
+    BigInt p = generate_prime(256, rng);
+    ASSERT_EQUAL(p.bit_length() == 256 && is_probable_prime(p, 10, PrimalityTest::BailliePSW), true, "256-bit prime");
+    // Диапазон за пределами uint64_t
+    BigInt lo = BigInt(1) << 300;
+    BigInt hi = lo + BigInt(100000);
+    BigInt q = generate_random_prime(lo, hi);
+    ASSERT_EQUAL(q >= lo && q <= hi && is_probable_prime(q), true, "Prime in a range above 2^64");
+    ASSERT_EQUAL(generate_random_prime(BigInt(24), BigInt(30)), 29LL, "Only prime in [24, 30]");
+    bool thrown = false;
+    try { generate_random_prime(BigInt(24), BigInt(28)); } catch (const std::runtime_error&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "No primes in [24, 28]");
+}
+
+void test_parallel_prime_search() {
+    using bignum::BigInt;
+    PrimeSearchOptions single;
+    single.seed = 77;
+    PrimeSearchOptions parallel = single;
+    parallel.threads = 4;
+    // С заданным зерном результат не зависит от числа потоков
+    BigInt a = generate_prime(192, single);
+    ASSERT_EQUAL(a, generate_prime(192, parallel), "Seeded search is reproducible across thread counts");
+    ASSERT_EQUAL(a.bit_length() == 192 && is_probable_prime(a), true, "Seeded search yields a 192-bit prime");
+
+    std::vector<BigInt> batch = generate_primes(5, 128, parallel);
+    std::vector<BigInt> batch_single = generate_primes(5, 128, single);
+    bool valid = batch.size() == 5;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        valid = valid && batch[i] == batch_single[i] && batch[i].bit_length() == 128 && is_probable_prime(batch[i]);
+    }
+    ASSERT_EQUAL(valid, true, "Batch of primes is valid and reproducible");
+    ASSERT_EQUAL(batch[0] != batch[1], true, "Batch elements use distinct seeds");
+
+    BigInt lo = BigInt(1) << 200;
+    BigInt q = generate_random_prime(lo, lo + BigInt(50000), parallel);
+    ASSERT_EQUAL(q, generate_random_prime(lo, lo + BigInt(50000), single), "Seeded range search");
+}
+
+void test_safe_prime_and_generator() {
+    using bignum::BigInt;
+    PrimeSearchOptions options;
+    options.seed = 314;
+    BigInt p = generate_safe_prime(160, options);
+    PrimeSearchOptions parallel = options;
+    parallel.threads = 3;
+    ASSERT_EQUAL(generate_safe_prime(160, parallel), p, "Seeded safe prime search is reproducible across thread counts");
+    BigInt q = (p - BigInt(1)) >> 1;
+    ASSERT_EQUAL(p.bit_length() == 160 && is_probable_prime(p) && is_probable_prime(q), true, "160-bit safe prime");
+    BigInt g = find_generator(p);
+    ASSERT_EQUAL(power_mod(g, q, p) != BigInt(1) && power_mod(g, BigInt(2), p) != BigInt(1), true, "Generator of Z_p*");
+    BigInt small = generate_safe_prime(5, options);
+    ASSERT_EQUAL(small, 23LL, "The only 5-bit safe prime");
+    ASSERT_EQUAL(find_generator(BigInt(23)), 5LL, "Smallest generator mod 23");
+    // 97 - 1 = 2^5 * 3
+    ASSERT_EQUAL(find_generator(BigInt(97), {BigInt(2), BigInt(3)}), 5LL, "Smallest generator mod 97");
+    bool thrown = false;
+    try { find_generator(BigInt(97)); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "find_generator rejects non-safe primes");
+}
+
 void test_extended_euclidean() {
     bignum::BigInt x, y;
 
@@ -71,6 +256,99 @@ void test_extended_euclidean() {
     ASSERT_EQUAL(nod2, 9LL, "GCD for large numbers");
     bignum::BigInt check2 = a * x + b * y;
     ASSERT_EQUAL(check2, 9LL, "for large numbers");
+
+    // Отрицательные аргументы: a*x + b*y = gcd(|a|, |b|)
+    bignum::BigInt nod3 = extended_euclidean(bignum::BigInt(-240), bignum::BigInt(46), x, y);
+    ASSERT_EQUAL(nod3, 2LL, "GCD(-240, 46)");
+    ASSERT_EQUAL(bignum::BigInt(-240) * x + bignum::BigInt(46) * y, 2LL, "Bezout for negative a");
+    ASSERT_EQUAL(extended_euclidean(bignum::BigInt(0), bignum::BigInt(-5), x, y), 5LL, "GCD(0, -5)");
+    ASSERT_EQUAL(bignum::BigInt(-5) * y, 5LL, "Bezout for GCD(0, -5)");
+
+    // Многолимбовые числа (шаги Лемера) и зона half-GCD с известным общим делителем
+    std::mt19937_64 rng(99);
+    for (size_t bits : {700, 12000}) {
+        bignum::BigInt common = random_bigint(150, rng);
+        bignum::BigInt u = random_bigint(bits, rng) * common;
+        bignum::BigInt v = random_bigint(bits - 40, rng) * common;
+        bignum::BigInt nod = extended_euclidean(u, v, x, y);
+        ASSERT_EQUAL(u * x + v * y, nod, "Bezout identity for multi-limb inputs");
+        ASSERT_EQUAL((u % nod).is_zero() && (v % nod).is_zero() && (nod % common).is_zero(), true, "GCD divides inputs");
+        ASSERT_EQUAL(extended_euclidean(u / nod, v / nod, x, y), 1LL, "Cofactors are coprime");
+        ASSERT_EQUAL((x.abs() << 1) <= v / nod, true, "Reduced Bezout coefficient");
+    }
+    // Последовательные числа Фибоначчи — худший случай по числу шагов
+    bignum::BigInt f0(0), f1(1);
+    for (int i = 0; i < 3000; ++i) {
+        bignum::BigInt t = f0 + f1;
+        f0 = f1;
+        f1 = t;
+    }
+    ASSERT_EQUAL(extended_euclidean(f1, f0, x, y), 1LL, "GCD of consecutive Fibonacci numbers");
+    ASSERT_EQUAL(f1 * x + f0 * y, 1LL, "Bezout for Fibonacci numbers");
+}
+
+void test_mod_inverse() {
+    using bignum::BigInt;
+    ASSERT_EQUAL(mod_inverse(BigInt(3), BigInt(11)), 4LL, "3^-1 mod 11");
+    ASSERT_EQUAL(mod_inverse(BigInt(-3), BigInt(11)), 7LL, "(-3)^-1 mod 11");
+    ASSERT_EQUAL(mod_inverse(BigInt(7), BigInt(-40)), 23LL, "7^-1 mod -40");
+    ASSERT_EQUAL(mod_inverse(BigInt(5), BigInt(1)), 0LL, "Inverse mod 1");
+    bool thrown = false;
+    try { mod_inverse(BigInt(6), BigInt(9)); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "mod_inverse rejects non-invertible values");
+
+    // Пакетное обращение: нечётный (Монтгомери) и чётный модули
+    std::mt19937_64 rng(16);
+    const BigInt p = generate_prime(256, rng);
+    const BigInt even = BigInt(1) << 255; // нечётные значения обратимы
+    for (const BigInt& mod : {p, even}) {
+        std::vector<BigInt> values;
+        for (int i = 0; i < 50; ++i) {
+            BigInt v = random_bigint(300, rng);
+            if (!mod.test_bit(0)) v |= BigInt(1);
+            if (i % 7 == 0) v = -v;
+            values.push_back(v);
+        }
+        std::vector<BigInt> inverses = values;
+        batch_mod_inverse(inverses, mod);
+        for (size_t i = 0; i < values.size(); ++i) {
+            ASSERT_EQUAL(inverses[i], mod_inverse(values[i], mod), "Batch inverse matches mod_inverse");
+        }
+    }
+    std::vector<BigInt> single = {BigInt(3)};
+    batch_mod_inverse(single, BigInt(11));
+    ASSERT_EQUAL(single[0], 4LL, "Batch of one element");
+    std::vector<BigInt> with_zero = {BigInt(3), BigInt(22), BigInt(5)};
+    thrown = false;
+    try { batch_mod_inverse(with_zero, BigInt(11)); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown && with_zero[1] == BigInt(22), true, "Batch rejects a zero element and keeps values");
+}
+
+void test_factorize() {
+    using bignum::BigInt;
+    using Factors = std::vector<std::pair<BigInt, unsigned>>;
+    auto check = [](const BigInt& n, const Factors& expected, const std::string& name) {
+        const Factors actual = factorize(n);
+        ASSERT_EQUAL(actual.size() == expected.size(), true, name + " (number of factors)");
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQUAL(actual[i].first, expected[i].first, name);
+            ASSERT_EQUAL(actual[i].second == expected[i].second, true, name + " (exponent)");
+        }
+    };
+    check(BigInt(1), {}, "factorize(1)");
+    check(BigInt(97), {{BigInt(97), 1}}, "Small prime");
+    check(BigInt(360), {{BigInt(2), 3}, {BigInt(3), 2}, {BigInt(5), 1}}, "Smooth number");
+
+    // Множители больше 2^16 достаются ро-методом, в том числе квадрат простого
+    const BigInt p1("1099511626793"), p2("2305843009213693951"), p3("65537"), p4("4294967291");
+    check(p1 * p2, {{p1, 1}, {p2, 1}}, "Product of two large primes");
+    check(p4 * p4 * BigInt(3).pow(5ULL), {{BigInt(3), 5}, {p4, 2}}, "Square of a large prime");
+    check(p3 * p1 * p2 * BigInt(1024), {{BigInt(2), 10}, {p3, 1}, {p1, 1}, {p2, 1}}, "Mixed factorization");
+    check(p1 * p1 * p1, {{p1, 3}}, "Cube of a 40-bit prime");
+
+    bool thrown = false;
+    try { factorize(BigInt(0)); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "factorize rejects zero");
 }
 
 
@@ -79,8 +357,17 @@ int main() {
     std::cout << "----------------------------------------" << std::endl;
 
     RUN_TEST(test_power_mod, "TestPowerMod");
+    RUN_TEST(test_fixed_base_pow_table, "TestFixedBasePowTable");
+    RUN_TEST(test_multi_power_mod, "TestMultiPowerMod");
+    RUN_TEST(test_multiply_mod, "TestMultiplyMod");
     RUN_TEST(test_is_prime_fermat, "TestIsPrimeFermat");
+    RUN_TEST(test_is_probable_prime, "TestIsProbablePrime");
+    RUN_TEST(test_random_and_prime_generation, "TestRandomAndPrimeGeneration");
+    RUN_TEST(test_parallel_prime_search, "TestParallelPrimeSearch");
+    RUN_TEST(test_safe_prime_and_generator, "TestSafePrimeAndGenerator");
     RUN_TEST(test_extended_euclidean, "TestExtendedEuclidean");
+    RUN_TEST(test_mod_inverse, "TestModInverse");
+    RUN_TEST(test_factorize, "TestFactorize");
 
     std::cout << "----------------------------------------" << std::endl;
     std::cout << "Test summary:" << std::endl;
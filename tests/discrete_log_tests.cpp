@@ -3,6 +3,7 @@
 #include <iostream>
 #include <string>
 #include <stdexcept>
+#include <vector>
 
 int tests_passed = 0;
 int tests_failed = 0;
@@ -59,12 +60,176 @@ void test_discrete_log_generated() {
     ASSERT_HAS_VALUE_AND_EQUAL(res, x_known, "discrete generated");
 }
 
+void test_discrete_log_parallel() {
+    // p = 2^36 - 5 — простое, 2 — образующий: логарифм единственен, m = 2^18 шагов малыша
+    const BigInt p("68719476731");
+    const BigInt a("2");
+    for (long long x_known : {0LL, 1LL, 262143LL, 262144LL, 987654321LL, 68719476729LL}) {
+        const BigInt y = power_mod(a, BigInt(x_known), p);
+        ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs(a, y, p), x_known, "sequential BSGS");
+        for (unsigned threads : {2u, 3u, 8u}) {
+            ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs_parallel(a, y, p, threads), x_known, "parallel BSGS");
+        }
+    }
+    // 5 не лежит в подгруппе порядка 11, порождённой 4 по модулю 23
+    if (discrete_log_bsgs_parallel(BigInt(4), BigInt(5), BigInt(23), 4).has_value()) {
+        throw std::runtime_error("Assertion failed in parallel BSGS: expected no logarithm");
+    }
+}
+
+void test_discrete_log_small_order() {
+    // a малого порядка: ord(a)-кратные повторы шагов малыша не должны копиться в таблице.
+    // p - 1 = 2 * 5 * 19 * 22605091, m = 65536
+    const BigInt p("4294967291");
+    const BigInt minus_one = p - BigInt(1); // порядок 2
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs(minus_one, BigInt(1), p), 0, "a = p - 1, y = 1");
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs(minus_one, minus_one, p), 1, "a = p - 1, y = p - 1");
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs_parallel(minus_one, minus_one, p, 3), 1, "parallel, a = p - 1");
+    const BigInt a = power_mod(BigInt(2), (p - BigInt(1)) / BigInt(5), p); // порядок 5 (2 — образующий)
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs(a, power_mod(a, BigInt(3), p), p), 3, "a of order 5");
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs_parallel(a, power_mod(a, BigInt(4), p), p, 3), 4, "parallel, a of order 5");
+    if (discrete_log_bsgs(minus_one, BigInt(2), p).has_value()) {
+        throw std::runtime_error("Assertion failed: 2 is not a power of p - 1");
+    }
+}
+
+void test_discrete_log_options() {
+    // Бюджет на 100 шагов малыша: m = 100 вместо 1001, шагов великана ~10^4
+    const BigInt p("1000003");
+    const BigInt a("2");
+    DiscreteLogOptions small;
+    small.memory_budget = 1000;
+    for (long long x_known : {0LL, 99LL, 100LL, 123456LL, 999999LL}) {
+        const BigInt y = power_mod(a, BigInt(x_known), p);
+        auto res = discrete_log_bsgs(a, y, p, small);
+        if (!res || !(power_mod(a, *res, p) == y)) throw std::runtime_error("Assertion failed in budgeted BSGS: wrong logarithm");
+    }
+
+    // 200-битное p = k*r + 1 и элемент порядка r = 1000003: по известному порядку
+    // работает и длинная арифметика, без ограничения на размер p
+    const BigInt r("1000003");
+    BigInt big_p;
+    for (BigInt k = (BigInt(1) << 180) / r * BigInt(2); ; k += BigInt(2)) {
+        big_p = k * r + BigInt(1);
+        if (is_probable_prime(big_p)) break;
+    }
+    const BigInt g = power_mod(BigInt(3), (big_p - BigInt(1)) / r, big_p);
+    const BigInt y = power_mod(g, BigInt(765432), big_p);
+    DiscreteLogOptions known;
+    known.order = r;
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs(g, y, big_p, known), 765432, "BSGS with known order");
+    known.memory_budget = 5000;
+    known.threads = 3;
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_bsgs(g, y, big_p, known), 765432, "BSGS with known order and small budget");
+
+    bool thrown = false;
+    try { discrete_log_bsgs(g, y, big_p, small); } catch (const std::invalid_argument&) { thrown = true; }
+    if (!thrown) throw std::runtime_error("Assertion failed: order beyond the budget must be rejected");
+    // Перегрузки без опций вместо исключения сообщают "не найдено"
+    if (discrete_log_bsgs(g, y, big_p).has_value() || discrete_log_bsgs_parallel(g, y, big_p, 2).has_value()) {
+        throw std::runtime_error("Assertion failed: order beyond the default budget must give no logarithm");
+    }
+    thrown = false;
+    DiscreteLogOptions empty;
+    empty.memory_budget = 5;
+    try { discrete_log_bsgs(a, a, p, empty); } catch (const std::invalid_argument&) { thrown = true; }
+    if (!thrown) throw std::runtime_error("Assertion failed: budget below one entry must be rejected");
+}
+
+void test_discrete_log_rho() {
+    // p = 2q + 1, q = 1099511626793 простое; 4 — квадратичный вычет, его порядок q
+    const BigInt q("1099511626793");
+    const BigInt p = q * BigInt(2) + BigInt(1);
+    const BigInt a("4");
+    for (long long x_known : {1LL, 987654321987LL}) {
+        const BigInt y = power_mod(a, BigInt(x_known), p);
+        ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho(a, y, p, q), x_known, "rho, 64-bit group");
+        ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho_parallel(a, y, p, q, 4), x_known, "parallel rho, 64-bit group");
+    }
+
+    // 200-битное p = k*r + 1 и подгруппа простого порядка r = 2^32 - 5
+    const BigInt r("4294967291");
+    BigInt big_p;
+    for (BigInt k = (BigInt(1) << 168) / r * BigInt(2); ; k += BigInt(2)) {
+        big_p = k * r + BigInt(1);
+        if (is_probable_prime(big_p)) break;
+    }
+    const BigInt g = power_mod(BigInt(3), (big_p - BigInt(1)) / r, big_p);
+    const BigInt y = power_mod(g, BigInt(3141592653LL), big_p);
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho(g, y, big_p, r), 3141592653LL, "rho, BigInt group");
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho_parallel(g, y, big_p, r, 3), 3141592653LL, "parallel rho, BigInt group");
+
+    // y вне [0, p): y + p и отрицательный представитель того же вычета
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho(g, y + big_p, big_p, r), 3141592653LL, "rho, y + p");
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho_parallel(g, y - big_p, big_p, r, 2), 3141592653LL, "parallel rho, negative y");
+    const BigInt y_small = power_mod(a, BigInt(987654321987LL), p);
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho(a + p, y_small + p, p, q), 987654321987LL, "rho, a + p and y + p");
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho(a, y_small - p, p, q), 987654321987LL, "rho, negative y");
+
+    // 2 — невычет, в подгруппе порядка q его нет
+    if (discrete_log_rho(a, BigInt(2), p, q).has_value()) {
+        throw std::runtime_error("Assertion failed in rho: expected no logarithm");
+    }
+    // Малый порядок уходит в BSGS
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_rho(BigInt(5), BigInt(3), BigInt(23), BigInt(22)), 16, "rho, small order");
+}
+void test_discrete_log_pohlig_hellman() {
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_pohlig_hellman(BigInt(5), BigInt(3), BigInt(23)), 16, "Pohlig-Hellman, p = 23");
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_pohlig_hellman(BigInt(5), BigInt(1), BigInt(23)), 0, "Pohlig-Hellman, y = 1");
+
+    // p - 1 = 2 * 3^4 * 5^2 * 7 * ... * 97 * q * k: гладкий порядок с одним 40-битным простым q
+    // (его цифра ищется rho) и k < 2^20; p около 170 бит — для BSGS по всей группе неподъёмно
+    BigInt smooth = BigInt(2) * BigInt(81) * BigInt(25);
+    for (int f : {7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97}) {
+        smooth *= BigInt(f);
+    }
+    smooth *= BigInt("1099511626793");
+    BigInt p;
+    for (BigInt k(1); ; k += BigInt(1)) {
+        p = smooth * k + BigInt(1);
+        if (is_probable_prime(p)) break;
+    }
+    std::vector<BigInt> prime_factors;
+    for (const auto& [f, e] : factorize(p - BigInt(1))) prime_factors.push_back(f);
+    const BigInt g = find_generator(p, prime_factors);
+
+    const BigInt x("123456789012345678901234567890123456789");
+    const BigInt x_known = x % (p - BigInt(1));
+    const BigInt y = power_mod(g, x, p);
+    std::optional<BigInt> found = discrete_log_pohlig_hellman(g, y, p);
+    if (!found || *found != x_known) throw std::runtime_error("Assertion failed in Pohlig-Hellman, smooth 170-bit p");
+    DiscreteLogOptions options;
+    options.threads = 2;
+    options.memory_budget = 1 << 12;
+    found = discrete_log_pohlig_hellman(g, y, p, options);
+    if (!found || *found != x_known) throw std::runtime_error("Assertion failed in Pohlig-Hellman, threads and budget");
+
+    // a не образующий: ответ — наименьший x по модулю порядка a, который делит p - 1
+    const BigInt a = power_mod(g, BigInt(2 * 81 * 7), p);
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_pohlig_hellman(a, power_mod(a, BigInt(1000003), p), p), 1000003,
+                               "Pohlig-Hellman, element of smaller order");
+    // Известный порядок подгруппы вместо p - 1
+    options = {};
+    options.order = (p - BigInt(1)) / BigInt(2 * 81 * 7);
+    ASSERT_HAS_VALUE_AND_EQUAL(discrete_log_pohlig_hellman(a, power_mod(a, BigInt(77), p), p, options), 77,
+                               "Pohlig-Hellman, known order");
+    // g не лежит в подгруппе квадратов
+    if (discrete_log_pohlig_hellman(power_mod(g, BigInt(2), p), g, p).has_value()) {
+        throw std::runtime_error("Assertion failed in Pohlig-Hellman: expected no logarithm");
+    }
+}
+
 int main() {
     std::cout << "Running discrete_log tests..." << std::endl;
     std::cout << "----------------------------------------" << std::endl;
 
     RUN_TEST(test_discrete_log_small, "TestDiscreteSmall");
     RUN_TEST(test_discrete_log_generated, "TestDiscreteGenerated");
+    RUN_TEST(test_discrete_log_parallel, "TestDiscreteParallel");
+    RUN_TEST(test_discrete_log_small_order, "TestDiscreteSmallOrder");
+    RUN_TEST(test_discrete_log_options, "TestDiscreteOptions");
+    RUN_TEST(test_discrete_log_rho, "TestDiscreteRho");
+    RUN_TEST(test_discrete_log_pohlig_hellman, "TestDiscretePohligHellman");
 
     std::cout << "----------------------------------------" << std::endl;
     std::cout << "Test summary:" << std::endl;
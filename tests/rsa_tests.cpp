@@ -0,0 +1,105 @@
+#include "rsa.hpp"
+#include "crypto_lib.hpp"
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+int tests_passed = 0;
+int tests_failed = 0;
+
+void ASSERT_EQUAL(const bignum::BigInt& actual, const bignum::BigInt& expected, const std::string& test_name) {
+    if (!(actual == expected)) {
+        std::string error_message = "Assertion failed in " + test_name +
+                                  ": Expected " + expected.to_dec_string() +
+                                  ", but got " + actual.to_dec_string();
+        throw std::runtime_error(error_message);
+    }
+}
+
+void ASSERT_EQUAL(bool actual, bool expected, const std::string& test_name) {
+    if (actual != expected) {
+        std::string error_message = "Assertion failed in " + test_name +
+                                  ": Expected " + (expected ? "true" : "false") +
+                                  ", but got " + (actual ? "true" : "false");
+        throw std::runtime_error(error_message);
+    }
+}
+
+void RUN_TEST(void (*test_func)(), const std::string& test_name) {
+    std::cout << "[ RUN      ] " << test_name << std::endl;
+    try {
+        test_func();
+        std::cout << "[       OK ] " << test_name << std::endl;
+        tests_passed++;
+    } catch (const std::runtime_error& e) {
+        std::cout << "[  FAILED  ] " << test_name << std::endl;
+        std::cerr << "    " << e.what() << std::endl;
+        tests_failed++;
+    }
+}
+
+using bignum::BigInt;
+
+void test_rsa_textbook_key() {
+    // p = 61, q = 53, e = 17: d = 17^{-1} mod lcm(60, 52) = 413
+    RsaPrivateKey key = rsa_key_from_primes(BigInt(53), BigInt(61), BigInt(17));
+    ASSERT_EQUAL(key.n, BigInt(3233), "n = p*q");
+    ASSERT_EQUAL(key.p, BigInt(61), "p is the larger prime");
+    ASSERT_EQUAL(key.d, BigInt(413), "d modulo lambda(n)");
+    ASSERT_EQUAL(key.dp, BigInt(53), "dp");
+    ASSERT_EQUAL(key.dq, BigInt(49), "dq");
+    ASSERT_EQUAL(key.q_inv, BigInt(38), "q_inv");
+
+    RsaPrivateEngine engine(key);
+    ASSERT_EQUAL(engine.public_engine().encrypt(BigInt(65)), BigInt(2790), "Encrypt 65");
+    ASSERT_EQUAL(engine.decrypt(BigInt(2790)), BigInt(65), "Decrypt 2790");
+    for (int64_t m : {0, 1, 60, 61, 3232}) {
+        ASSERT_EQUAL(engine.decrypt(engine.public_engine().encrypt(BigInt(m))), BigInt(m), "Round trip on edge values");
+    }
+
+    bool thrown = false;
+    try { engine.decrypt(BigInt(3233)); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "decrypt rejects c >= n");
+    thrown = false;
+    try { rsa_key_from_primes(BigInt(61), BigInt(53), BigInt(3)); } catch (const std::invalid_argument&) { thrown = true; }
+    ASSERT_EQUAL(thrown, true, "e not coprime to lambda(n)");
+}
+
+void test_rsa_generated_key() {
+    PrimeSearchOptions options;
+    options.seed = 20;
+    RsaPrivateKey key = rsa_generate_key(1024, options);
+    ASSERT_EQUAL(key.n.bit_length() == 1024, true, "Modulus has exactly 1024 bits");
+    ASSERT_EQUAL(is_probable_prime(key.p) && is_probable_prime(key.q), true, "Factors are prime");
+    ASSERT_EQUAL(rsa_generate_key(1024, options).n, key.n, "Seeded generation is reproducible");
+    ASSERT_EQUAL(rsa_generate_key(523, options).n.bit_length() == 523, true, "Odd modulus length");
+
+    RsaPrivateEngine engine(key);
+    const RsaPublicEngine& pub = engine.public_engine();
+    std::mt19937_64 rng(20);
+    for (int i = 0; i < 3; ++i) {
+        const BigInt m = random_below(key.n, rng);
+        const BigInt c = pub.encrypt(m);
+        ASSERT_EQUAL(c, power_mod(m, key.e, key.n), "Encrypt matches power_mod");
+        ASSERT_EQUAL(engine.decrypt(c), m, "CRT decrypt recovers message");
+        ASSERT_EQUAL(engine.decrypt(c), power_mod(c, key.d, key.n), "CRT decrypt matches c^d mod n");
+        const BigInt s = engine.sign(m);
+        ASSERT_EQUAL(pub.verify(m, s), true, "Signature verifies");
+        ASSERT_EQUAL(pub.verify(m + BigInt(1), s), false, "Signature of another message");
+    }
+}
+
+int main() {
+    std::cout << "Running rsa tests..." << std::endl;
+    std::cout << "----------------------------------------" << std::endl;
+
+    RUN_TEST(test_rsa_textbook_key, "TestRsaTextbookKey");
+    RUN_TEST(test_rsa_generated_key, "TestRsaGeneratedKey");
+
+    std::cout << "----------------------------------------" << std::endl;
+    std::cout << "Test summary:" << std::endl;
+    std::cout << "PASSED: " << tests_passed << std::endl;
+    std::cout << "FAILED: " << tests_failed << std::endl;
+
+    return (tests_failed == 0) ? 0 : 1;
+}